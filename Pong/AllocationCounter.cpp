@@ -0,0 +1,54 @@
+#include "AllocationCounter.h"
+
+#ifdef PONG_COUNT_ALLOCATIONS
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+static std::atomic<Uint64> allocationCount(0);
+
+Uint64 GetAllocationCount()
+{
+	return allocationCount.load(std::memory_order_relaxed);
+}
+
+// The array, nothrow and sized forms all end up in these by default
+
+void* operator new(std::size_t size)
+{
+	allocationCount.fetch_add(1, std::memory_order_relaxed);
+	if (size == 0) {
+		size = 1;
+	}
+	while (true) {
+		void* memory = std::malloc(size);
+		if (memory) {
+			return memory;
+		}
+		std::new_handler handler = std::get_new_handler();
+		if (!handler) {
+			throw std::bad_alloc();
+		}
+		handler();
+	}
+}
+
+void operator delete(void* memory) noexcept
+{
+	std::free(memory);
+}
+
+void operator delete(void* memory, std::size_t) noexcept
+{
+	std::free(memory);
+}
+
+#else
+
+Uint64 GetAllocationCount()
+{
+	return 0;
+}
+
+#endif
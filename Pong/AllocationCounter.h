@@ -0,0 +1,12 @@
+#pragma once
+#include "SDL/SDL.h"
+
+// Number of operator new calls so far, from every thread. Global new and
+// delete are replaced in AllocationCounter.cpp to count them; the headless
+// benchmark uses the difference across frames to check that the steady
+// state doesn't touch the heap.
+//
+// Only builds with PONG_COUNT_ALLOCATIONS defined (the Benchmark
+// configuration) replace new and delete, so other builds don't pay for
+// the counting. Without it this always returns 0.
+Uint64 GetAllocationCount();
@@ -0,0 +1,242 @@
+#include "AssetArchive.h"
+
+#include <algorithm>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#ifdef _WIN32
+#define NOMINMAX // std::min / std::max, not the macros
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+static const char archiveMagic[4] = { 'P', 'G', 'P', 'K' };
+static const Uint32 archiveVersion = 1;
+static const size_t archiveHeaderSize = 12;
+static const size_t archiveEntrySize = 128;
+static const size_t archiveNameSize = 120;
+
+static bool ReadWholeFile(const char* path, std::vector<Uint8>& data)
+{
+	SDL_RWops* file = SDL_RWFromFile(path, "rb");
+	if (!file) {
+		SDL_Log("Failed to open %s: %s", path, SDL_GetError());
+		return false;
+	}
+	const Sint64 size = SDL_RWsize(file);
+	data.resize(size > 0 ? static_cast<size_t>(size) : 0);
+	const bool read = size >= 0 && (data.empty() || SDL_RWread(file, data.data(), data.size(), 1) == 1);
+	SDL_RWclose(file);
+	if (!read) {
+		SDL_Log("Failed to read %s", path);
+	}
+	return read;
+}
+
+bool PackAssets(const char* archivePath, const char* const* paths, int count)
+{
+	// Data goes in the order given, so files loaded together can be packed
+	// next to each other. The table of contents is sorted by name so the
+	// game can binary search it.
+	std::vector<std::string> names(paths, paths + count);
+	for (std::string& name : names) {
+		std::replace(name.begin(), name.end(), '\\', '/');
+	}
+	std::vector<int> sorted(names.size());
+	for (size_t i = 0; i < sorted.size(); ++i) {
+		sorted[i] = static_cast<int>(i);
+	}
+	std::sort(sorted.begin(), sorted.end(), [&names](int a, int b) { return names[a] < names[b]; });
+	for (size_t i = 1; i < sorted.size(); ++i) {
+		if (names[sorted[i]] == names[sorted[i - 1]]) {
+			SDL_Log("Can't pack %s twice", names[sorted[i]].c_str());
+			return false;
+		}
+	}
+
+	std::vector<std::vector<Uint8>> contents(names.size());
+	std::vector<Uint32> offsets(names.size());
+	size_t offset = archiveHeaderSize + archiveEntrySize * names.size();
+	for (size_t i = 0; i < names.size(); ++i) {
+		if (names[i].size() >= archiveNameSize) {
+			SDL_Log("%s: names are limited to %d characters", names[i].c_str(), static_cast<int>(archiveNameSize - 1));
+			return false;
+		}
+		if (!ReadWholeFile(names[i].c_str(), contents[i])) {
+			return false;
+		}
+		offset = (offset + archiveAlignment - 1) / archiveAlignment * archiveAlignment;
+		offsets[i] = static_cast<Uint32>(offset);
+		offset += contents[i].size();
+		if (offset > 0xFFFFFFFF) {
+			SDL_Log("%s doesn't fit, archives are limited to 4 GB", names[i].c_str());
+			return false;
+		}
+	}
+
+	SDL_RWops* file = SDL_RWFromFile(archivePath, "wb");
+	if (!file) {
+		SDL_Log("Failed to create %s: %s", archivePath, SDL_GetError());
+		return false;
+	}
+	bool written = SDL_RWwrite(file, archiveMagic, sizeof(archiveMagic), 1) == 1;
+	written = written && SDL_WriteLE32(file, archiveVersion) == 1;
+	written = written && SDL_WriteLE32(file, static_cast<Uint32>(names.size())) == 1;
+	for (size_t i = 0; i < sorted.size() && written; ++i) {
+		const int entry = sorted[i];
+		char name[archiveNameSize] = {};
+		memcpy(name, names[entry].c_str(), names[entry].size());
+		written = SDL_RWwrite(file, name, sizeof(name), 1) == 1;
+		written = written && SDL_WriteLE32(file, offsets[entry]) == 1;
+		written = written && SDL_WriteLE32(file, static_cast<Uint32>(contents[entry].size())) == 1;
+	}
+	size_t position = archiveHeaderSize + archiveEntrySize * names.size();
+	for (size_t i = 0; i < names.size() && written; ++i) {
+		static const Uint8 padding[archiveAlignment] = {};
+		const size_t paddingSize = offsets[i] - position;
+		written = paddingSize == 0 || SDL_RWwrite(file, padding, paddingSize, 1) == 1;
+		written = written && (contents[i].empty() || SDL_RWwrite(file, contents[i].data(), contents[i].size(), 1) == 1);
+		position = offsets[i] + contents[i].size();
+	}
+	SDL_RWclose(file);
+
+	if (!written) {
+		SDL_Log("Failed to write %s", archivePath);
+		return false;
+	}
+	SDL_Log("Packed %d files into %s (%u bytes)", count, archivePath, static_cast<Uint32>(position));
+	return true;
+}
+
+AssetArchive::AssetArchive()
+	: mData(nullptr)
+	, mSize(0)
+	, mEntries(nullptr)
+	, mEntryCount(0)
+#ifdef _WIN32
+	, mFile(INVALID_HANDLE_VALUE)
+	, mMapping(nullptr)
+#endif
+{
+}
+
+AssetArchive::~AssetArchive()
+{
+	Close();
+}
+
+bool AssetArchive::Open(const char* path)
+{
+	Close();
+
+#ifdef _WIN32
+	mFile = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+	if (mFile == INVALID_HANDLE_VALUE) {
+		return false;
+	}
+	LARGE_INTEGER fileSize;
+	if (!GetFileSizeEx(mFile, &fileSize) || fileSize.QuadPart == 0) {
+		Close();
+		return false;
+	}
+	mMapping = CreateFileMappingA(mFile, nullptr, PAGE_READONLY, 0, 0, nullptr);
+	mData = mMapping ? static_cast<const Uint8*>(MapViewOfFile(mMapping, FILE_MAP_READ, 0, 0, 0)) : nullptr;
+	mSize = static_cast<size_t>(fileSize.QuadPart);
+#else
+	const int file = open(path, O_RDONLY);
+	if (file < 0) {
+		return false;
+	}
+	struct stat status;
+	if (fstat(file, &status) != 0 || status.st_size == 0) {
+		close(file);
+		return false;
+	}
+	mSize = static_cast<size_t>(status.st_size);
+	void* data = mmap(nullptr, mSize, PROT_READ, MAP_PRIVATE, file, 0);
+	close(file); // The mapping keeps the file open
+	mData = data != MAP_FAILED ? static_cast<const Uint8*>(data) : nullptr;
+#endif
+	if (!mData) {
+		SDL_Log("Failed to map %s", path);
+		Close();
+		return false;
+	}
+
+	// Check the table of contents once, so lookups can trust it
+	Uint32 entryCount = 0;
+	bool valid = mSize >= archiveHeaderSize && memcmp(mData, archiveMagic, sizeof(archiveMagic)) == 0;
+	if (valid) {
+		Uint32 version;
+		memcpy(&version, mData + 4, sizeof(version));
+		memcpy(&entryCount, mData + 8, sizeof(entryCount));
+		valid = SDL_SwapLE32(version) == archiveVersion;
+		entryCount = SDL_SwapLE32(entryCount);
+	}
+	valid = valid && entryCount <= (mSize - archiveHeaderSize) / archiveEntrySize;
+	mEntries = reinterpret_cast<const Entry*>(mData + archiveHeaderSize);
+	for (Uint32 i = 0; i < entryCount && valid; ++i) {
+		const Entry& entry = mEntries[i];
+		const Uint64 end = static_cast<Uint64>(SDL_SwapLE32(entry.offset)) + SDL_SwapLE32(entry.size);
+		valid = entry.name[sizeof(entry.name) - 1] == '\0' && end <= mSize;
+	}
+	if (!valid) {
+		SDL_Log("%s isn't an asset archive", path);
+		Close();
+		return false;
+	}
+	mEntryCount = entryCount;
+	return true;
+}
+
+void AssetArchive::Close()
+{
+#ifdef _WIN32
+	if (mData) {
+		UnmapViewOfFile(mData);
+	}
+	if (mMapping) {
+		CloseHandle(mMapping);
+		mMapping = nullptr;
+	}
+	if (mFile != INVALID_HANDLE_VALUE) {
+		CloseHandle(mFile);
+		mFile = INVALID_HANDLE_VALUE;
+	}
+#else
+	if (mData) {
+		munmap(const_cast<Uint8*>(mData), mSize);
+	}
+#endif
+	mData = nullptr;
+	mSize = 0;
+	mEntries = nullptr;
+	mEntryCount = 0;
+}
+
+const Uint8* AssetArchive::Find(const char* name, size_t& size) const
+{
+	const Entry* end = mEntries + mEntryCount;
+	const Entry* entry = std::lower_bound(mEntries, end, name, [](const Entry& entry, const char* name) {
+		return strncmp(entry.name, name, sizeof(entry.name)) < 0;
+	});
+	if (entry == end || strncmp(entry->name, name, sizeof(entry->name)) != 0) {
+		size = 0;
+		return nullptr;
+	}
+	size = SDL_SwapLE32(entry->size);
+	return mData + SDL_SwapLE32(entry->offset);
+}
+
+SDL_RWops* AssetArchive::OpenEntry(const char* name) const
+{
+	size_t size = 0;
+	const Uint8* data = Find(name, size);
+	return data ? SDL_RWFromConstMem(data, static_cast<int>(size)) : nullptr;
+}
@@ -0,0 +1,61 @@
+#pragma once
+#include "SDL/SDL.h"
+
+#include <cstddef>
+
+// All game assets in one file, packed at build time with
+// Game.exe --pack <archive> <file>... (post-build step). The archive is
+// memory mapped whole, so startup opens one file instead of one per asset,
+// and entries are handed to SDL over the mapping without being copied.
+//
+// File layout (little endian):
+//     "PGPK"  Uint32 version  Uint32 entry count
+//     entry count x { char name[120], Uint32 offset, Uint32 size }, sorted by name
+//     entry data in the order packed, each starting on an archiveAlignment boundary
+// Names are the relative paths the game loads them by, with '/' separators.
+// Pack what startup loads first and streamed music last, so a cold start
+// reads one contiguous run of the file.
+
+const int archiveAlignment = 16;
+
+// Pack the files into an archive, false on failure
+bool PackAssets(const char* archivePath, const char* const* paths, int count);
+
+class AssetArchive
+{
+public:
+	AssetArchive();
+	~AssetArchive();
+
+	// Map the archive, false if it's missing or not a valid archive
+	bool Open(const char* path);
+	void Close();
+	bool IsOpen() const { return mData != nullptr; }
+
+	// Bytes of an entry inside the mapping, nullptr if it isn't packed.
+	// Valid until Close.
+	const Uint8* Find(const char* name, size_t& size) const;
+
+	// Read-only SDL_RWops over an entry, nullptr if it isn't packed.
+	// Close it (or pass freesrc) when done; the archive must stay open.
+	SDL_RWops* OpenEntry(const char* name) const;
+
+	int GetEntryCount() const { return static_cast<int>(mEntryCount); }
+
+private:
+	struct Entry
+	{
+		char name[120]; // Null terminated
+		Uint32 offset; // From the start of the file
+		Uint32 size;
+	};
+
+	const Uint8* mData;
+	size_t mSize;
+	const Entry* mEntries; // Table of contents, in the mapping
+	Uint32 mEntryCount;
+#ifdef _WIN32
+	void* mFile;
+	void* mMapping;
+#endif
+};
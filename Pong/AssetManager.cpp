@@ -0,0 +1,304 @@
+#include "AssetManager.h"
+#include "AudioConvert.h"
+#include "Profiler.h"
+
+#include "SDL/SDL_image.h"
+
+const int maxAssets = 256;
+
+AssetManager::AssetManager()
+	: mRenderer(nullptr)
+	, mArchive(nullptr)
+	, mAssets(maxAssets)
+	, mWake(nullptr)
+	, mQuit(false)
+{
+}
+
+AssetManager::~AssetManager()
+{
+	Shutdown();
+}
+
+bool AssetManager::Initialize(SDL_Renderer* renderer, const AssetArchive* archive, int loaderCount)
+{
+	mRenderer = renderer;
+	mArchive = archive;
+	mQuit = false;
+	mWake = SDL_CreateSemaphore(0);
+	for (int i = 0; i < loaderCount; ++i) {
+		SDL_Thread* loader = SDL_CreateThread(LoaderThread, "Asset Loader", this);
+		if (!loader) {
+			SDL_Log("Failed to start an asset loader: %s", SDL_GetError());
+			Shutdown();
+			return false;
+		}
+		mLoaders.push_back(loader);
+	}
+	return true;
+}
+
+void AssetManager::Shutdown()
+{
+	// Stop the loaders first, after that every request is either done or never started
+	mQuit = true;
+	for (size_t i = 0; i < mLoaders.size(); ++i) {
+		SDL_SemPost(mWake);
+	}
+	for (SDL_Thread* loader : mLoaders) {
+		SDL_WaitThread(loader, nullptr);
+	}
+	mLoaders.clear();
+	if (mWake) {
+		SDL_DestroySemaphore(mWake);
+		mWake = nullptr;
+	}
+
+	mQueue.clear();
+	for (auto& request : mInFlight) {
+		FreeResults(*request);
+	}
+	mInFlight.clear();
+
+	// Newest first, in case later assets were made from earlier ones
+	int leftOver = 0;
+	for (auto handle = mLoadOrder.rbegin(); handle != mLoadOrder.rend(); ++handle) {
+		Asset* asset = mAssets.Get(*handle);
+		if (asset) {
+			FreeAsset(*asset);
+			mAssets.Destroy(*handle);
+			++leftOver;
+		}
+	}
+	if (leftOver > 0) {
+		SDL_Log("Freed %d assets that were still referenced at shutdown", leftOver);
+	}
+	mLoadOrder.clear();
+	for (auto& byPath : mByPath) {
+		byPath.clear();
+	}
+}
+
+AssetHandle AssetManager::LoadTexture(const char* path)
+{
+	return Load(AssetTexture, path);
+}
+
+AssetHandle AssetManager::LoadSound(const char* path)
+{
+	return Load(AssetSound, path);
+}
+
+AssetHandle AssetManager::Load(AssetType type, const char* path)
+{
+	// A path loaded as the other type is a different asset
+	auto existing = mByPath[type].find(path);
+	if (existing != mByPath[type].end()) {
+		AddReference(existing->second);
+		return existing->second;
+	}
+
+	Asset asset;
+	asset.type = type;
+	asset.path = path;
+	asset.references = 1;
+	asset.texture = nullptr;
+	asset.sound = nullptr;
+	asset.samples = nullptr;
+	AssetHandle handle = mAssets.Create(asset);
+	if (handle == nullAsset) {
+		SDL_Log("Can't load %s, already %d assets loaded", path, mAssets.GetCapacity());
+		return nullAsset;
+	}
+	mByPath[type][path] = handle;
+	mLoadOrder.push_back(handle);
+
+	std::unique_ptr<LoadRequest> request(new LoadRequest());
+	request->asset = handle;
+	request->type = type;
+	request->path = path;
+	request->cancelled = false;
+	request->done = false;
+	request->surface = nullptr;
+	request->sound = nullptr;
+	request->samples = nullptr;
+
+	if (mLoaders.empty()) {
+		Decode(*request); // No loader threads, load right here
+		request->done = true;
+	}
+	else {
+		std::lock_guard<std::mutex> lock(mQueueMutex);
+		mQueue.push_back(request.get());
+	}
+	mInFlight.push_back(std::move(request));
+	if (!mLoaders.empty()) {
+		SDL_SemPost(mWake);
+	}
+	return handle;
+}
+
+void AssetManager::AddReference(AssetHandle handle)
+{
+	Asset* asset = mAssets.Get(handle);
+	if (asset) {
+		++asset->references;
+	}
+}
+
+void AssetManager::Release(AssetHandle handle)
+{
+	Asset* asset = mAssets.Get(handle);
+	if (!asset || --asset->references > 0) {
+		return;
+	}
+
+	// A load still running finishes on its own, Update throws the result away
+	for (auto& request : mInFlight) {
+		if (request->asset == handle) {
+			request->cancelled = true;
+		}
+	}
+	mByPath[asset->type].erase(asset->path);
+	FreeAsset(*asset);
+	mAssets.Destroy(handle);
+}
+
+void AssetManager::Update()
+{
+	PROFILE_ZONE("Assets");
+
+	for (size_t i = 0; i < mInFlight.size();) {
+		LoadRequest& request = *mInFlight[i];
+		if (!request.done.load(std::memory_order_acquire)) {
+			++i;
+			continue;
+		}
+
+		Asset* asset = mAssets.Get(request.asset);
+		if (asset) {
+			if (request.surface) {
+				asset->texture = SDL_CreateTextureFromSurface(mRenderer, request.surface);
+				if (!asset->texture) {
+					SDL_Log("Failed to create a texture for %s: %s", request.path.c_str(), SDL_GetError());
+				}
+			}
+			asset->sound = request.sound;
+			asset->samples = request.samples;
+			request.sound = nullptr;
+			request.samples = nullptr;
+		}
+		FreeResults(request);
+
+		// Order doesn't matter, swap and pop
+		mInFlight[i] = std::move(mInFlight.back());
+		mInFlight.pop_back();
+	}
+}
+
+SDL_Texture* AssetManager::GetTexture(AssetHandle handle) const
+{
+	const Asset* asset = mAssets.Get(handle);
+	return asset ? asset->texture : nullptr;
+}
+
+Mix_Chunk* AssetManager::GetSound(AssetHandle handle) const
+{
+	const Asset* asset = mAssets.Get(handle);
+	return asset ? asset->sound : nullptr;
+}
+
+void AssetManager::FreeAsset(Asset& asset)
+{
+	if (asset.texture) {
+		SDL_DestroyTexture(asset.texture);
+		asset.texture = nullptr;
+	}
+	if (asset.sound) {
+		Mix_FreeChunk(asset.sound);
+		asset.sound = nullptr;
+	}
+	SDL_free(asset.samples);
+	asset.samples = nullptr;
+}
+
+void AssetManager::FreeResults(LoadRequest& request)
+{
+	if (request.surface) {
+		SDL_FreeSurface(request.surface);
+		request.surface = nullptr;
+	}
+	if (request.sound) {
+		Mix_FreeChunk(request.sound);
+		request.sound = nullptr;
+	}
+	SDL_free(request.samples);
+	request.samples = nullptr;
+}
+
+int SDLCALL AssetManager::LoaderThread(void* manager)
+{
+	static_cast<AssetManager*>(manager)->RunLoader();
+	return 0;
+}
+
+void AssetManager::RunLoader()
+{
+	Profiler::Get().SetThreadName("Asset Loader");
+
+	while (!mQuit) {
+		SDL_SemWait(mWake);
+
+		LoadRequest* request = nullptr;
+		{
+			std::lock_guard<std::mutex> lock(mQueueMutex);
+			if (!mQueue.empty()) {
+				request = mQueue.front();
+				mQueue.pop_front();
+			}
+		}
+		if (request && !mQuit) {
+			if (!request->cancelled) {
+				Decode(*request);
+			}
+			request->done.store(true, std::memory_order_release);
+		}
+	}
+}
+
+void AssetManager::Decode(LoadRequest& request) const
+{
+	// Packed assets are decoded straight from the mapped archive
+	const char* path = request.path.c_str();
+	if (request.type == AssetTexture) {
+		SDL_RWops* packed = mArchive ? mArchive->OpenEntry(path) : nullptr;
+		request.surface = packed ? IMG_Load_RW(packed, 1) : IMG_Load(path);
+		if (!request.surface) {
+			SDL_Log("Failed to load %s: %s", path, IMG_GetError());
+		}
+		return;
+	}
+
+	// Sounds: the copy converted at build time loads without any conversion
+	std::string converted = request.path;
+	const size_t extension = converted.rfind('.');
+	if (extension != std::string::npos) {
+		converted.erase(extension);
+	}
+	converted += ".pcm";
+	size_t convertedSize = 0;
+	const Uint8* convertedData = mArchive ? mArchive->Find(converted.c_str(), convertedSize) : nullptr;
+	if (convertedData) {
+		request.sound = LoadConvertedSound(convertedData, convertedSize, converted.c_str()); // Plays from the mapping, no copy
+	}
+	else {
+		request.sound = LoadConvertedSound(converted.c_str(), request.samples);
+	}
+	if (!request.sound) {
+		SDL_RWops* packed = mArchive ? mArchive->OpenEntry(path) : nullptr;
+		request.sound = packed ? Mix_LoadWAV_RW(packed, 1) : Mix_LoadWAV(path);
+		if (!request.sound) {
+			SDL_Log("Failed to load %s: %s", path, Mix_GetError());
+		}
+	}
+}
@@ -0,0 +1,115 @@
+#pragma once
+#include "SDL/SDL.h"
+#include "AssetArchive.h"
+#include "Pool.h"
+
+#include <SDL/SDL_mixer.h>
+
+#include <atomic>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Reference counted handle to a texture or sound in the AssetManager
+typedef PoolHandle AssetHandle;
+const AssetHandle nullAsset = nullPoolHandle;
+
+// Loads textures and sounds in the background. Files are read and decoded
+// on loader threads, from the archive when it has them and from loose
+// files otherwise; textures are then created on the render thread in
+// Update, since SDL renderers only work on the thread that made them.
+// Until then GetTexture / GetSound return null, so callers skip drawing or
+// playing what isn't there yet.
+//
+// Loading the same path as the same type twice returns the same asset with
+// one more reference; Release drops one and frees the asset with the last.
+// Shutdown frees whatever is left, newest first. Everything except the
+// loader threads runs on the render (main) thread.
+//
+// Loaders are threads of their own rather than jobs: a load mostly waits
+// on the disk, and would hold a worker the frame's ParallelFors need.
+class AssetManager
+{
+public:
+	AssetManager();
+	~AssetManager();
+
+	// The archive, if any, must stay open until after Shutdown
+	bool Initialize(SDL_Renderer* renderer, const AssetArchive* archive = nullptr, int loaderCount = 2);
+	void Shutdown();
+
+	// Queue a load, or add a reference to the asset already loaded from path
+	AssetHandle LoadTexture(const char* path);
+	AssetHandle LoadSound(const char* path); // Prefers a pre-converted .pcm copy
+
+	void AddReference(AssetHandle asset);
+	void Release(AssetHandle asset);
+
+	// Create the textures of finished loads. Call once per frame.
+	void Update();
+
+	// Null while loading, after a failed load, or for a stale handle
+	SDL_Texture* GetTexture(AssetHandle asset) const;
+	Mix_Chunk* GetSound(AssetHandle asset) const;
+
+	int GetPendingCount() const { return static_cast<int>(mInFlight.size()); }
+
+private:
+	enum AssetType
+	{
+		AssetTexture,
+		AssetSound,
+		AssetTypeCount
+	};
+
+	struct Asset
+	{
+		AssetType type;
+		std::string path;
+		int references;
+		SDL_Texture* texture;
+		Mix_Chunk* sound;
+		Uint8* samples; // Owned next to the chunk for pre-converted sounds
+	};
+
+	// One load, shared with a loader thread until done is set
+	struct LoadRequest
+	{
+		AssetHandle asset;
+		AssetType type;
+		std::string path;
+		std::atomic<bool> cancelled; // Released before it finished, skip the work
+		std::atomic<bool> done;
+
+		// Results, written by the loader
+		SDL_Surface* surface;
+		Mix_Chunk* sound;
+		Uint8* samples;
+	};
+
+	AssetHandle Load(AssetType type, const char* path);
+	void FreeAsset(Asset& asset);
+	static void FreeResults(LoadRequest& request);
+
+	static int SDLCALL LoaderThread(void* manager);
+	void RunLoader();
+	void Decode(LoadRequest& request) const;
+
+	SDL_Renderer* mRenderer;
+	const AssetArchive* mArchive; // Read only, shared with the loaders
+	Pool<Asset> mAssets;
+	std::unordered_map<std::string, AssetHandle> mByPath[AssetTypeCount]; // Loaded assets by type, then path
+	std::vector<AssetHandle> mLoadOrder; // For freeing newest first at Shutdown
+
+	std::vector<std::unique_ptr<LoadRequest>> mInFlight; // Render thread
+
+	// Shared with the loaders
+	std::vector<SDL_Thread*> mLoaders;
+	SDL_sem* mWake; // Posted once per queued request, and per loader to quit
+	std::mutex mQueueMutex;
+	std::deque<LoadRequest*> mQueue;
+	std::atomic<bool> mQuit;
+};
@@ -0,0 +1,136 @@
+#include "AudioConvert.h"
+
+#include <cstring>
+#include <vector>
+
+static const char convertedMagic[4] = { 'P', 'G', 'A', 'U' };
+static const Uint32 convertedVersion = 1;
+
+bool ConvertSound(const char* wavPath, const char* outPath, int frequency, Uint16 format, int channels)
+{
+	SDL_AudioSpec spec;
+	Uint8* wavSamples = nullptr;
+	Uint32 wavLength = 0;
+	if (!SDL_LoadWAV(wavPath, &spec, &wavSamples, &wavLength)) {
+		SDL_Log("Failed to load %s: %s", wavPath, SDL_GetError());
+		return false;
+	}
+
+	SDL_AudioCVT cvt;
+	if (SDL_BuildAudioCVT(&cvt, spec.format, spec.channels, spec.freq, format, static_cast<Uint8>(channels), frequency) < 0) {
+		SDL_Log("Can't convert %s: %s", wavPath, SDL_GetError());
+		SDL_FreeWAV(wavSamples);
+		return false;
+	}
+
+	// SDL_ConvertAudio works in place, in a buffer len_mult times the input
+	std::vector<Uint8> samples(wavLength * cvt.len_mult);
+	memcpy(samples.data(), wavSamples, wavLength);
+	SDL_FreeWAV(wavSamples);
+	Uint32 length = wavLength;
+	if (cvt.needed) {
+		cvt.buf = samples.data();
+		cvt.len = static_cast<int>(wavLength);
+		if (SDL_ConvertAudio(&cvt) < 0) {
+			SDL_Log("Failed to convert %s: %s", wavPath, SDL_GetError());
+			return false;
+		}
+		length = static_cast<Uint32>(cvt.len_cvt);
+	}
+
+	SDL_RWops* file = SDL_RWFromFile(outPath, "wb");
+	if (!file) {
+		SDL_Log("Failed to create %s: %s", outPath, SDL_GetError());
+		return false;
+	}
+	bool written = SDL_RWwrite(file, convertedMagic, sizeof(convertedMagic), 1) == 1;
+	written = written && SDL_WriteLE32(file, convertedVersion) == 1;
+	written = written && SDL_WriteLE32(file, static_cast<Uint32>(frequency)) == 1;
+	written = written && SDL_WriteLE16(file, format) == 1;
+	written = written && SDL_WriteLE16(file, static_cast<Uint16>(channels)) == 1;
+	written = written && SDL_WriteLE32(file, length) == 1;
+	written = written && (length == 0 || SDL_RWwrite(file, samples.data(), length, 1) == 1);
+	SDL_RWclose(file);
+
+	if (!written) {
+		SDL_Log("Failed to write %s", outPath);
+		return false;
+	}
+	SDL_Log("Converted %s to %s (%d Hz, format 0x%04x, %d channels, %u bytes)", wavPath, outPath, frequency, format, channels, length);
+	return true;
+}
+
+// Check a converted sound's header against the mixer, leaving file at the samples
+static bool ReadConvertedHeader(SDL_RWops* file, const char* path, Uint32& length)
+{
+	char magic[4];
+	const bool validMagic = SDL_RWread(file, magic, sizeof(magic), 1) == 1 && memcmp(magic, convertedMagic, sizeof(magic)) == 0;
+	const Uint32 version = SDL_ReadLE32(file);
+	const int fileFrequency = static_cast<int>(SDL_ReadLE32(file));
+	const Uint16 fileFormat = SDL_ReadLE16(file);
+	const int fileChannels = SDL_ReadLE16(file);
+	length = SDL_ReadLE32(file);
+	if (!validMagic || version != convertedVersion) {
+		SDL_Log("%s isn't a converted sound", path);
+		return false;
+	}
+
+	// The mixer may have opened the device with a different format than asked for
+	int frequency = 0;
+	Uint16 format = 0;
+	int channels = 0;
+	if (!Mix_QuerySpec(&frequency, &format, &channels) ||
+		frequency != fileFrequency || format != fileFormat || channels != fileChannels) {
+		SDL_Log("%s is %d Hz, format 0x%04x, %d channels but the mixer runs %d Hz, format 0x%04x, %d channels",
+			path, fileFrequency, fileFormat, fileChannels, frequency, format, channels);
+		return false;
+	}
+	return true;
+}
+
+Mix_Chunk* LoadConvertedSound(const char* path, Uint8*& samples)
+{
+	samples = nullptr;
+	SDL_RWops* file = SDL_RWFromFile(path, "rb");
+	if (!file) {
+		return nullptr; // Not converted
+	}
+
+	Uint32 length = 0;
+	if (!ReadConvertedHeader(file, path, length)) {
+		SDL_RWclose(file);
+		return nullptr;
+	}
+
+	samples = static_cast<Uint8*>(SDL_malloc(length));
+	const bool read = samples && (length == 0 || SDL_RWread(file, samples, length, 1) == 1);
+	SDL_RWclose(file);
+	Mix_Chunk* chunk = read ? Mix_QuickLoad_RAW(samples, length) : nullptr;
+	if (!chunk) {
+		SDL_Log("Failed to read %s", path);
+		SDL_free(samples);
+		samples = nullptr;
+	}
+	return chunk;
+}
+
+Mix_Chunk* LoadConvertedSound(const Uint8* data, size_t size, const char* name)
+{
+	SDL_RWops* file = SDL_RWFromConstMem(data, static_cast<int>(size));
+	Uint32 length = 0;
+	const bool valid = file && ReadConvertedHeader(file, name, length);
+	const Sint64 start = valid ? SDL_RWtell(file) : 0;
+	if (file) {
+		SDL_RWclose(file);
+	}
+	if (!valid) {
+		return nullptr;
+	}
+	if (start + length > static_cast<Sint64>(size)) {
+		SDL_Log("%s is cut short", name);
+		return nullptr;
+	}
+
+	// The mixer only reads the samples, so play them straight from data
+	return Mix_QuickLoad_RAW(const_cast<Uint8*>(data + start), length);
+}
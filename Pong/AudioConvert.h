@@ -0,0 +1,29 @@
+#pragma once
+#include "SDL/SDL.h"
+
+#include <SDL/SDL_mixer.h>
+
+// Output format the game opens the mixer with
+const int audioFrequency = 44100;
+const Uint16 audioFormat = MIX_DEFAULT_FORMAT;
+const int audioChannels = 2;
+
+// Sound effects converted ahead of time to the mixer's output format, so
+// loading them is one read with no resampling and no conversion buffer.
+// File layout (little endian):
+//     "PGAU"  Uint32 version  Uint32 frequency  Uint16 format  Uint16 channels
+//     Uint32 byte count, then the samples
+// The build runs Game.exe --convert-audio on the WAVs (post-build step).
+
+// Convert a WAV to the given format and write it out, false on failure
+bool ConvertSound(const char* wavPath, const char* outPath, int frequency, Uint16 format, int channels);
+
+// Load a converted sound straight into a chunk. Returns nullptr when the
+// file is missing or was converted for a different format than the mixer
+// has open (the caller then falls back to the WAV). The chunk doesn't own
+// samples: free them with SDL_free after Mix_FreeChunk.
+Mix_Chunk* LoadConvertedSound(const char* path, Uint8*& samples);
+
+// Same for a converted sound already in memory, such as an AssetArchive
+// entry. The chunk plays the samples in place: data must outlive it.
+Mix_Chunk* LoadConvertedSound(const Uint8* data, size_t size, const char* name);
@@ -0,0 +1,197 @@
+#include "AudioService.h"
+#include "Profiler.h"
+
+AudioService::AudioService()
+	: mSoundCount(0)
+	, mFrame(1)
+	, mThread(nullptr)
+	, mWake(nullptr)
+	, mQuit(false)
+	, mVoiceCounter(0)
+	, mDropped(0)
+	, mUnvoiced(0)
+{
+}
+
+SoundId AudioService::AddSound(int priority)
+{
+	if (mSoundCount == maxSounds) {
+		SDL_Log("Too many sounds, %d at most", maxSounds);
+		return invalidSound;
+	}
+	Sound& sound = mSounds[mSoundCount];
+	sound.chunk.store(nullptr, std::memory_order_relaxed);
+	sound.priority = priority;
+	sound.requestedFrame = 0;
+	return mSoundCount++;
+}
+
+void AudioService::SetSound(SoundId sound, Mix_Chunk* chunk)
+{
+	if (sound >= 0 && sound < mSoundCount) {
+		mSounds[sound].chunk.store(chunk, std::memory_order_release);
+	}
+}
+
+bool AudioService::Start(int voiceCount)
+{
+	Mix_AllocateChannels(voiceCount);
+	Voice idle = { invalidSound, 0, 0 };
+	mVoices.assign(voiceCount, idle);
+
+	mQuit = false;
+	mWake = SDL_CreateSemaphore(0);
+	mThread = SDL_CreateThread(AudioThread, "Audio", this);
+	if (!mThread) {
+		SDL_Log("Failed to start the audio thread: %s", SDL_GetError());
+		SDL_DestroySemaphore(mWake);
+		mWake = nullptr;
+		return false;
+	}
+	return true;
+}
+
+void AudioService::Shutdown()
+{
+	if (mThread) {
+		mQuit = true;
+		SDL_SemPost(mWake);
+		SDL_WaitThread(mThread, nullptr);
+		mThread = nullptr;
+		SDL_DestroySemaphore(mWake);
+		mWake = nullptr;
+	}
+
+	Mix_HaltChannel(-1); // The chunks can be freed after this
+	mSoundCount = 0;
+	mVoices.clear();
+}
+
+void AudioService::Play(SoundId sound, int volume)
+{
+	if (sound < 0 || sound >= mSoundCount) {
+		return;
+	}
+
+	// Once per frame is enough, a second copy on top would only be louder
+	Sound& entry = mSounds[sound];
+	if (entry.requestedFrame == mFrame) {
+		return;
+	}
+	entry.requestedFrame = mFrame;
+
+	Command command = { CommandPlay, sound, volume };
+	Push(command);
+}
+
+void AudioService::Stop(SoundId sound)
+{
+	Command command = { CommandStop, sound, 0 };
+	Push(command);
+}
+
+void AudioService::SetVolume(SoundId sound, int volume)
+{
+	Command command = { CommandVolume, sound, volume };
+	Push(command);
+}
+
+void AudioService::EndFrame()
+{
+	++mFrame;
+	if (mWake && !mCommands.IsEmpty()) {
+		SDL_SemPost(mWake);
+	}
+}
+
+void AudioService::Push(const Command& command)
+{
+	if (!mCommands.Push(command)) {
+		mDropped.fetch_add(1, std::memory_order_relaxed);
+	}
+}
+
+int SDLCALL AudioService::AudioThread(void* service)
+{
+	static_cast<AudioService*>(service)->RunAudio();
+	return 0;
+}
+
+void AudioService::RunAudio()
+{
+	Profiler::Get().SetThreadName("Audio");
+
+	while (!mQuit) {
+		SDL_SemWait(mWake);
+		Command command;
+		while (mCommands.Pop(command)) {
+			Execute(command);
+		}
+	}
+}
+
+void AudioService::Execute(const Command& command)
+{
+	if (command.sound < 0 || command.sound >= mSoundCount) {
+		return;
+	}
+	const Sound& sound = mSounds[command.sound];
+	Mix_Chunk* chunk = sound.chunk.load(std::memory_order_acquire);
+
+	switch (command.type) {
+	case CommandPlay: {
+		if (!chunk) {
+			return; // Not loaded yet
+		}
+		const int voice = FindVoice(sound.priority);
+		if (voice < 0) {
+			mUnvoiced.fetch_add(1, std::memory_order_relaxed);
+			return;
+		}
+		Mix_Volume(voice, command.volume);
+		if (Mix_PlayChannel(voice, chunk, 0) < 0) {
+			return;
+		}
+		Voice& playing = mVoices[voice];
+		playing.sound = command.sound;
+		playing.priority = sound.priority;
+		playing.started = ++mVoiceCounter;
+		break;
+	}
+	case CommandStop:
+		for (int i = 0; i < static_cast<int>(mVoices.size()); ++i) {
+			if (mVoices[i].sound == command.sound) {
+				Mix_HaltChannel(i);
+				mVoices[i].sound = invalidSound;
+			}
+		}
+		break;
+	case CommandVolume:
+		if (chunk) {
+			Mix_VolumeChunk(chunk, command.volume);
+		}
+		break;
+	}
+}
+
+int AudioService::FindVoice(int priority)
+{
+	// A voice that finished is free, otherwise the oldest of the lowest priority
+	int steal = -1;
+	for (int i = 0; i < static_cast<int>(mVoices.size()); ++i) {
+		const Voice& voice = mVoices[i];
+		if (voice.sound == invalidSound || !Mix_Playing(i)) {
+			return i;
+		}
+		if (voice.priority <= priority) {
+			if (steal < 0 || voice.priority < mVoices[steal].priority ||
+				(voice.priority == mVoices[steal].priority && voice.started < mVoices[steal].started)) {
+				steal = i;
+			}
+		}
+	}
+	if (steal >= 0) {
+		Mix_HaltChannel(steal);
+	}
+	return steal;
+}
@@ -0,0 +1,108 @@
+#pragma once
+#include "SDL/SDL.h"
+#include "SpscQueue.h"
+
+#include <SDL/SDL_mixer.h>
+
+#include <atomic>
+#include <vector>
+
+// Index of a sound registered with AudioService::AddSound
+typedef int SoundId;
+const SoundId invalidSound = -1;
+
+// Sound effects played from the game without touching the mixer there.
+// Requests go into a lock-free queue and an audio thread makes the mixer
+// calls (each of which takes SDL's audio lock). The thread plays them on a
+// fixed set of voices; when all are busy, a new sound takes over the oldest
+// voice with the lowest priority not above its own, or is dropped.
+//
+// The audio data comes from elsewhere (AssetManager) and can arrive after
+// the sound was registered: until SetSound gives it a chunk, requests for
+// the sound are ignored.
+//
+// Play, Stop, SetVolume and EndFrame must all be called from one thread
+// (the simulation). A request costs a flag check and a queue push and
+// never waits: the same sound asked for twice in one frame plays once,
+// and requests that don't fit in a full queue are dropped.
+class AudioService
+{
+public:
+	AudioService();
+
+	// Register a sound with a priority (higher steals voices from lower).
+	// Call before Start.
+	SoundId AddSound(int priority);
+
+	// Audio data for a sound, from any thread. The chunk stays owned by
+	// the caller and has to outlive Shutdown.
+	void SetSound(SoundId sound, Mix_Chunk* chunk);
+
+	// Allocate voiceCount mixer channels and start the audio thread
+	bool Start(int voiceCount);
+	void Shutdown(); // Stops every voice
+
+	// Game thread
+	void Play(SoundId sound, int volume = MIX_MAX_VOLUME);
+	void Stop(SoundId sound); // Every voice playing it
+	void SetVolume(SoundId sound, int volume);
+	void EndFrame(); // Wake the audio thread for this frame's requests
+
+	// Requests dropped because the queue was full, and plays that found no voice
+	int GetDroppedCount() const { return mDropped.load(std::memory_order_relaxed); }
+	int GetUnvoicedCount() const { return mUnvoiced.load(std::memory_order_relaxed); }
+
+private:
+	enum CommandType
+	{
+		CommandPlay,
+		CommandStop,
+		CommandVolume
+	};
+
+	struct Command
+	{
+		CommandType type;
+		SoundId sound;
+		int volume;
+	};
+
+	struct Sound
+	{
+		std::atomic<Mix_Chunk*> chunk; // Null until SetSound
+		int priority;
+		Uint32 requestedFrame; // Last frame a Play for it was queued (game thread)
+	};
+
+	struct Voice
+	{
+		SoundId sound; // invalidSound when idle
+		int priority;
+		Uint32 started; // Order the voice started in, for stealing the oldest
+	};
+
+	static const int commandQueueSize = 256;
+	static const int maxSounds = 64;
+
+	void Push(const Command& command);
+
+	static int SDLCALL AudioThread(void* service);
+	void RunAudio();
+	void Execute(const Command& command);
+	int FindVoice(int priority);
+
+	Sound mSounds[maxSounds];
+	int mSoundCount;
+	SpscQueue<Command, commandQueueSize> mCommands;
+	Uint32 mFrame; // Game thread
+
+	// Audio thread
+	SDL_Thread* mThread;
+	SDL_sem* mWake;
+	std::atomic<bool> mQuit;
+	std::vector<Voice> mVoices;
+	Uint32 mVoiceCounter;
+
+	std::atomic<int> mDropped;
+	std::atomic<int> mUnvoiced;
+};
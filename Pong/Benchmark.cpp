@@ -0,0 +1,379 @@
+#include "Benchmark.h"
+#include "AudioConvert.h"
+#include "AudioService.h"
+#include "BlockBatcher.h"
+#include "Collision.h"
+#include "JobSystem.h"
+#include "World.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+
+#ifdef _WIN32
+#define NOMINMAX // std::min / std::max, not the macros
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#include <psapi.h>
+#else
+#include <sys/resource.h>
+#endif
+
+// The same blocks stored both ways, dense grid for the old scan
+// and chunked world for what the game uses now
+struct BenchWorld
+{
+	BlockGrid grid;
+	World world;
+};
+
+// Old path: test every cell in the grid
+static int FullScan(const BenchWorld& bench, const SDL_Rect& rect, int cellSize)
+{
+	int hits = 0;
+	for (int x = 0; x < bench.grid.GetWidth(); ++x) {
+		for (int y = 0; y < bench.grid.GetHeight(); ++y) {
+			if (bench.grid.At(x, y) != emptyBlock) {
+				SDL_Rect blockRect = { x * cellSize, y * cellSize, cellSize, cellSize };
+				if (CheckCollision(rect, blockRect)) {
+					++hits;
+				}
+			}
+		}
+	}
+	return hits;
+}
+
+// New path: only test the cells under the rect
+static int RangeQuery(const BenchWorld& bench, const SDL_Rect& rect, int cellSize)
+{
+	int hits = 0;
+	CellRange cells = GetOverlappingCells(rect, cellSize, bench.grid.GetWidth(), bench.grid.GetHeight());
+	for (int x = cells.minX; x <= cells.maxX; ++x) {
+		for (int y = cells.minY; y <= cells.maxY; ++y) {
+			if (bench.grid.At(x, y) != emptyBlock) {
+				SDL_Rect blockRect = { x * cellSize, y * cellSize, cellSize, cellSize };
+				if (CheckCollision(rect, blockRect)) {
+					++hits;
+				}
+			}
+		}
+	}
+	return hits;
+}
+
+// New path against the chunked world, as UpdateGame does it
+static int WorldRangeQuery(const BenchWorld& bench, const SDL_Rect& rect, int cellSize)
+{
+	int hits = 0;
+	CellRange cells = GetOverlappingCells(rect, cellSize);
+	for (int x = cells.minX; x <= cells.maxX; ++x) {
+		for (int y = cells.minY; y <= cells.maxY; ++y) {
+			if (bench.world.Get(x, y) != emptyBlock) {
+				SDL_Rect blockRect = { x * cellSize, y * cellSize, cellSize, cellSize };
+				if (CheckCollision(rect, blockRect)) {
+					++hits;
+				}
+			}
+		}
+	}
+	return hits;
+}
+
+// Run a query repeatedly for roughly the time budget, return microseconds per query
+typedef int (*QueryFunc)(const BenchWorld&, const SDL_Rect&, int);
+static double TimeQuery(QueryFunc query, const BenchWorld& bench, int cellSize, int& hits)
+{
+	const double budgetSeconds = 0.5;
+	const Uint64 frequency = SDL_GetPerformanceFrequency();
+	const Uint64 start = SDL_GetPerformanceCounter();
+	const int width = bench.grid.GetWidth();
+	const int height = bench.grid.GetHeight();
+
+	// Player sized hitbox walking along the bottom rows of the grid
+	SDL_Rect rect = { 0, (height - 3) * cellSize + cellSize / 2, 50, 100 };
+
+	int iterations = 0;
+	Uint64 now = start;
+	hits = 0;
+	do {
+		rect.x = (iterations * 7) % (width * cellSize);
+		hits += query(bench, rect, cellSize);
+		++iterations;
+		now = SDL_GetPerformanceCounter();
+	} while ((now - start) < budgetSeconds * frequency && iterations < 1000000);
+
+	return (now - start) * 1000000.0 / frequency / iterations;
+}
+
+void RunCollisionBenchmark()
+{
+	const int cellSize = 50;
+	const int sizes[][2] = {
+		{ 20, 15 },
+		{ 1000, 1000 },
+		{ 10000, 10000 }
+	};
+
+	SDL_Log("Collision benchmark (microseconds per player query)");
+	for (const auto& size : sizes) {
+		const int width = size[0];
+		const int height = size[1];
+
+		// Bottom three rows solid (the floor), plus a sparse scatter of blocks
+		BenchWorld bench = { BlockGrid(width, height), World() };
+		for (int x = 0; x < width; ++x) {
+			for (int y = height - 3; y < height; ++y) {
+				bench.grid.At(x, y) = 1;
+				bench.world.Set(x, y, 1);
+			}
+			bench.grid.At(x, (x * 31) % height) = 1;
+			bench.world.Set(x, (x * 31) % height, 1);
+		}
+
+		// All paths have to agree before timing means anything
+		SDL_Rect probe = { cellSize * (width / 2) + 10, (height - 3) * cellSize - 40, 50, 100 };
+		const int expected = FullScan(bench, probe, cellSize);
+		if (RangeQuery(bench, probe, cellSize) != expected || WorldRangeQuery(bench, probe, cellSize) != expected) {
+			SDL_Log("  %5d x %-5d  MISMATCH between full scan and range query", width, height);
+		}
+
+		int fullHits = 0;
+		int rangeHits = 0;
+		int worldHits = 0;
+		double fullTime = TimeQuery(FullScan, bench, cellSize, fullHits);
+		double rangeTime = TimeQuery(RangeQuery, bench, cellSize, rangeHits);
+		double worldTime = TimeQuery(WorldRangeQuery, bench, cellSize, worldHits);
+
+		SDL_Log("  %5d x %-5d  full scan: %12.3f us   range query: %8.3f us   chunked world: %8.3f us   speedup: %10.1fx",
+			width, height, fullTime, rangeTime, worldTime, fullTime / worldTime);
+	}
+}
+
+// Milliseconds per call of pass, best of a few runs
+template <typename Pass>
+static double TimePass(const Pass& pass)
+{
+	const double ticksToMs = 1000.0 / SDL_GetPerformanceFrequency();
+	double best = 0.0;
+	for (int run = 0; run < 10; ++run) {
+		const Uint64 start = SDL_GetPerformanceCounter();
+		pass();
+		const double time = (SDL_GetPerformanceCounter() - start) * ticksToMs;
+		if (run == 0 || time < best) {
+			best = time;
+		}
+	}
+	return best;
+}
+
+void RunJobBenchmark()
+{
+	// 64 x 64 chunks with every other cell solid, batched the way DrawBlocks does
+	const int chunksPerSide = 64;
+	World world;
+	for (int y = 0; y < chunksPerSide * chunkSize; ++y) {
+		for (int x = (y & 1); x < chunksPerSide * chunkSize; x += 2) {
+			world.Set(x, y, static_cast<BlockId>(1 + (x + y) % (blockPaletteSize - 1)));
+		}
+	}
+	std::vector<const Chunk*> chunks;
+	for (const auto& entry : world.GetChunks()) {
+		chunks.push_back(entry.second.get());
+	}
+	const CellRange allCells = { 0, 0, chunksPerSide * chunkSize - 1, chunksPerSide * chunkSize - 1 };
+
+	// A million clouds, moved and wrapped like Game::Simulate does
+	struct BenchCloud
+	{
+		float x;
+		float prevX;
+		float speed;
+		int width;
+	};
+	std::vector<BenchCloud> clouds(1000000);
+	for (size_t i = 0; i < clouds.size(); ++i) {
+		BenchCloud cloud = { static_cast<float>(i % 1024), 0.0f, static_cast<float>(i % 100), 200 };
+		clouds[i] = cloud;
+	}
+
+	const int coreCount = SDL_GetCPUCount();
+	SDL_Log("Job system benchmark (%d cores, best of 10, milliseconds per pass)", coreCount);
+
+	double baseChunks = 0.0;
+	double baseClouds = 0.0;
+	for (int threads = 1; threads <= coreCount; ++threads) {
+		// The calling thread helps while it waits, so N threads is N - 1 workers
+		JobSystem jobs;
+		jobs.Initialize(threads - 1);
+
+		const int chunkBatch = jobs.GetBatchSize(static_cast<int>(chunks.size()), 2);
+		std::vector<BlockBatcher> batchers((chunks.size() + chunkBatch - 1) / chunkBatch);
+		int rects = 0;
+		const double chunkTime = TimePass([&] {
+			jobs.ParallelFor(static_cast<int>(chunks.size()), chunkBatch, [&](int begin, int end) {
+				BlockBatcher& batcher = batchers[begin / chunkBatch];
+				for (int i = begin; i < end; ++i) {
+					batcher.AddChunk(*chunks[i], allCells, 50, 0, 0);
+				}
+			});
+			rects = 0;
+			for (BlockBatcher& batcher : batchers) {
+				rects += batcher.GetRectCount();
+				batcher.Clear();
+			}
+		});
+
+		const int cloudBatch = jobs.GetBatchSize(static_cast<int>(clouds.size()), 256);
+		const double cloudTime = TimePass([&] {
+			jobs.ParallelFor(static_cast<int>(clouds.size()), cloudBatch, [&](int begin, int end) {
+				for (int i = begin; i < end; ++i) {
+					BenchCloud& cloud = clouds[i];
+					cloud.prevX = cloud.x;
+					cloud.x += cloud.speed * (1.0f / 120.0f);
+					if (cloud.x > 1024.0f) {
+						cloud.x = -static_cast<float>(cloud.width);
+						cloud.prevX = cloud.x;
+					}
+				}
+			});
+		});
+
+		if (threads == 1) {
+			baseChunks = chunkTime;
+			baseClouds = cloudTime;
+		}
+		SDL_Log("  %2d threads  chunk batching: %8.3f ms (%4.2fx, %d rects)   clouds: %8.3f ms (%4.2fx)",
+			threads, chunkTime, baseChunks / chunkTime, rects, cloudTime, baseClouds / cloudTime);
+	}
+}
+
+// Microseconds per load of the jump sound, from the WAV and from the converted copy
+static void TimeSoundLoads()
+{
+	const int loads = 50;
+	const double ticksToUs = 1000000.0 / SDL_GetPerformanceFrequency();
+
+	Uint64 start = SDL_GetPerformanceCounter();
+	for (int i = 0; i < loads; ++i) {
+		Mix_FreeChunk(Mix_LoadWAV("se_jump_003.wav"));
+	}
+	const double wavTime = (SDL_GetPerformanceCounter() - start) * ticksToUs / loads;
+
+	Uint8* samples = nullptr;
+	Mix_Chunk* chunk = LoadConvertedSound("se_jump_003.pcm", samples);
+	if (!chunk) {
+		SDL_Log("  WAV load: %8.1f us   (no se_jump_003.pcm, run --convert-audio to compare)", wavTime);
+		return;
+	}
+	Mix_FreeChunk(chunk);
+	SDL_free(samples);
+
+	start = SDL_GetPerformanceCounter();
+	for (int i = 0; i < loads; ++i) {
+		Mix_FreeChunk(LoadConvertedSound("se_jump_003.pcm", samples));
+		SDL_free(samples);
+	}
+	const double convertedTime = (SDL_GetPerformanceCounter() - start) * ticksToUs / loads;
+	SDL_Log("  WAV load: %8.1f us   converted load: %8.1f us", wavTime, convertedTime);
+}
+
+void RunAudioBenchmark()
+{
+	// Loading needs an open mixer, the dummy driver has the same format
+	SDL_setenv("SDL_AUDIODRIVER", "dummy", 1);
+	if (Mix_OpenAudio(audioFrequency, audioFormat, audioChannels, 2400) == 0) {
+		SDL_Log("Sound load benchmark (microseconds per load)");
+		TimeSoundLoads();
+		Mix_CloseAudio();
+	}
+
+	// Sounds without audio data, so only the request path is timed (the
+	// audio thread still drains the queue, it just has nothing to mix)
+	const int soundCount = 64;
+	AudioService audio;
+	for (int i = 0; i < soundCount; ++i) {
+		audio.AddSound(i % 4);
+	}
+	audio.Start(16);
+
+	const int frames = 100000;
+	const double ticksToNs = 1000000000.0 / SDL_GetPerformanceFrequency();
+	SDL_Log("Audio request benchmark (nanoseconds per Play call, %d frames)", frames);
+
+	// Both times include one EndFrame per frame
+	// The same sound requested 64 times a frame: one queued, the rest deduplicated
+	Uint64 start = SDL_GetPerformanceCounter();
+	for (int frame = 0; frame < frames; ++frame) {
+		for (int i = 0; i < soundCount; ++i) {
+			audio.Play(0);
+		}
+		audio.EndFrame();
+	}
+	SDL_Log("  repeats of one sound:  %6.2f ns", (SDL_GetPerformanceCounter() - start) * ticksToNs / (frames * soundCount));
+
+	// 64 different sounds a frame, every one goes through the queue
+	start = SDL_GetPerformanceCounter();
+	for (int frame = 0; frame < frames; ++frame) {
+		for (int i = 0; i < soundCount; ++i) {
+			audio.Play(i);
+		}
+		audio.EndFrame();
+	}
+	SDL_Log("  different sounds:      %6.2f ns (%d of %d dropped on a full queue)",
+		(SDL_GetPerformanceCounter() - start) * ticksToNs / (frames * soundCount), audio.GetDroppedCount(), frames * soundCount);
+
+	audio.Shutdown();
+}
+
+size_t GetPeakResidentBytes()
+{
+#ifdef _WIN32
+	PROCESS_MEMORY_COUNTERS counters;
+	if (GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters))) {
+		return counters.PeakWorkingSetSize;
+	}
+	return 0;
+#else
+	rusage usage;
+	if (getrusage(RUSAGE_SELF, &usage) != 0) {
+		return 0;
+	}
+#ifdef __APPLE__
+	return static_cast<size_t>(usage.ru_maxrss); // Bytes on macOS
+#else
+	return static_cast<size_t>(usage.ru_maxrss) * 1024; // Kilobytes on Linux
+#endif
+#endif
+}
+
+void PhaseStats::PrintHeader()
+{
+	printf("phase,frames,min_ms,mean_ms,p50_ms,p99_ms,max_ms\n");
+}
+
+void PhaseStats::Print(const char* phase) const
+{
+	if (mSamples.empty()) {
+		printf("%s,0,0,0,0,0,0\n", phase);
+		return;
+	}
+
+	std::vector<double> sorted(mSamples);
+	std::sort(sorted.begin(), sorted.end());
+
+	double total = 0.0;
+	for (double sample : sorted) {
+		total += sample;
+	}
+
+	// Nearest-rank percentile: the smallest sample with at least p of them at or below it
+	const size_t count = sorted.size();
+	auto percentile = [&](double p) {
+		const double index = std::ceil(p * count) - 1.0;
+		return sorted[static_cast<size_t>(std::min(std::max(index, 0.0), static_cast<double>(count - 1)))];
+	};
+
+	printf("%s,%u,%.4f,%.4f,%.4f,%.4f,%.4f\n", phase, static_cast<unsigned>(count),
+		sorted.front(), total / count, percentile(0.50), percentile(0.99), sorted.back());
+}
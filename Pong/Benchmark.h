@@ -0,0 +1,41 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+// Compares the old full-grid collision scan against the cell range query
+// on 20x15, 1k x 1k and 10k x 10k grids and logs the results.
+// Run with: Game.exe --bench-collision
+void RunCollisionBenchmark();
+
+// Times the job system's ParallelFor on the chunk batching and cloud loops
+// with 1 up to one thread per core and logs the speedup over one thread.
+// Run with: Game.exe --bench-jobs
+void RunJobBenchmark();
+
+// Times AudioService::Play on the game thread, for repeats that are
+// deduplicated and for requests that go through the queue.
+// Run with: Game.exe --bench-audio
+void RunAudioBenchmark();
+
+// Most memory the process has had resident so far, in bytes (0 if the
+// platform can't tell)
+size_t GetPeakResidentBytes();
+
+// Per-frame durations of one phase of the game loop (input, update, output),
+// reported as min/mean/p50/p99/max for the headless benchmark run
+class PhaseStats
+{
+public:
+	void Reserve(int frames) { mSamples.reserve(frames); }
+	void Add(double milliseconds) { mSamples.push_back(milliseconds); }
+
+	// Print one CSV row: phase,frames,min,mean,p50,p99,max (milliseconds)
+	void Print(const char* phase) const;
+
+	// Header row matching Print
+	static void PrintHeader();
+
+private:
+	std::vector<double> mSamples;
+};
@@ -0,0 +1,63 @@
+#include "BlockBatcher.h"
+
+#include <algorithm>
+
+void BlockBatcher::AddChunk(const Chunk& chunk, const CellRange& visibleCells, int cellSize, int viewX, int viewY)
+{
+	const int firstCellX = chunk.chunkX * chunkSize;
+	const int firstCellY = chunk.chunkY * chunkSize;
+	const int startX = std::max(visibleCells.minX - firstCellX, 0);
+	const int startY = std::max(visibleCells.minY - firstCellY, 0);
+	const int endX = std::min(visibleCells.maxX - firstCellX, chunkSize - 1);
+	const int endY = std::min(visibleCells.maxY - firstCellY, chunkSize - 1);
+
+	for (int y = startY; y <= endY; ++y) {
+		const BlockId* row = &chunk.blocks[y * chunkSize];
+		const int screenY = (firstCellY + y) * cellSize - viewY;
+		for (int x = startX; x <= endX; ++x) {
+			if (row[x] != emptyBlock) {
+				SDL_Rect rect = { (firstCellX + x) * cellSize - viewX, screenY, cellSize, cellSize };
+				mRects[row[x]].push_back(rect);
+			}
+		}
+	}
+}
+
+void BlockBatcher::Merge(BlockBatcher& other)
+{
+	for (int id = 0; id < blockPaletteSize; ++id) {
+		std::vector<SDL_Rect>& rects = other.mRects[id];
+		mRects[id].insert(mRects[id].end(), rects.begin(), rects.end());
+		rects.clear();
+	}
+}
+
+void BlockBatcher::Flush(RenderLayers& layers)
+{
+	for (int id = 0; id < blockPaletteSize; ++id) {
+		std::vector<SDL_Rect>& rects = mRects[id];
+		if (rects.empty()) {
+			continue;
+		}
+
+		layers.SetDrawColor(blockPalette[id]);
+		layers.FillRects(rects.data(), static_cast<int>(rects.size()));
+		rects.clear();
+	}
+}
+
+void BlockBatcher::Clear()
+{
+	for (int id = 0; id < blockPaletteSize; ++id) {
+		mRects[id].clear();
+	}
+}
+
+int BlockBatcher::GetRectCount() const
+{
+	int count = 0;
+	for (int id = 0; id < blockPaletteSize; ++id) {
+		count += static_cast<int>(mRects[id].size());
+	}
+	return count;
+}
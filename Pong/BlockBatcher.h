@@ -0,0 +1,44 @@
+#pragma once
+#include "Collision.h"
+#include "RenderLayers.h"
+#include "World.h"
+
+#include <vector>
+
+// Collects solid block rects by palette entry, then draws each color with a
+// single SDL_RenderFillRects call. A screen full of blocks costs one draw call
+// per palette entry instead of one per block. The rect lists keep their
+// capacity between frames, so batching doesn't allocate once warmed up.
+class BlockBatcher
+{
+public:
+	BlockBatcher()
+	{
+		// Enough for a typical frame, so the lists rarely grow after startup
+		for (std::vector<SDL_Rect>& rects : mRects) {
+			rects.reserve(256);
+		}
+	}
+
+	void Add(BlockId id, const SDL_Rect& rect)
+	{
+		mRects[id].push_back(rect);
+	}
+
+	// Add the solid cells of a chunk that fall inside visibleCells, in screen
+	// space for a view whose top left is at viewX, viewY (world pixels)
+	void AddChunk(const Chunk& chunk, const CellRange& visibleCells, int cellSize, int viewX, int viewY);
+
+	// Move another batcher's rects into this one (batches built on job threads)
+	void Merge(BlockBatcher& other);
+
+	// Draw and clear every non-empty batch into the current layer
+	void Flush(RenderLayers& layers);
+
+	// Drop everything without drawing
+	void Clear();
+	int GetRectCount() const;
+
+private:
+	std::vector<SDL_Rect> mRects[blockPaletteSize];
+};
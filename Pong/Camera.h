@@ -0,0 +1,70 @@
+#pragma once
+#include "SDL/SDL.h"
+
+#include <algorithm>
+#include <cmath>
+
+// Scrolling view into the world. Everything in the world (blocks, pickups,
+// clouds, the player) lives in world pixels, the camera turns those into
+// screen pixels and back (for mouse picking).
+class Camera
+{
+public:
+	Camera(int viewWidth, int viewHeight)
+		: mX(0.0f)
+		, mY(0.0f)
+		, mViewWidth(viewWidth)
+		, mViewHeight(viewHeight)
+	{
+	}
+
+	// Center the view on a world position. The view never scrolls below
+	// y = 0, the bottom of the screen is the bottom of the world.
+	void Follow(float x, float y)
+	{
+		mX = x - mViewWidth / 2.0f;
+		mY = std::min(0.0f, y - mViewHeight / 2.0f);
+	}
+
+	// Top left of the view in whole world pixels
+	int GetX() const { return static_cast<int>(std::floor(mX)); }
+	int GetY() const { return static_cast<int>(std::floor(mY)); }
+
+	// Part of the world currently on screen
+	SDL_Rect GetViewRect() const
+	{
+		SDL_Rect view = { GetX(), GetY(), mViewWidth, mViewHeight };
+		return view;
+	}
+
+	SDL_Rect WorldToScreen(const SDL_Rect& rect) const
+	{
+		SDL_Rect screen = { rect.x - GetX(), rect.y - GetY(), rect.w, rect.h };
+		return screen;
+	}
+
+	SDL_Point WorldToScreen(int x, int y) const
+	{
+		SDL_Point screen = { x - GetX(), y - GetY() };
+		return screen;
+	}
+
+	SDL_Point ScreenToWorld(int x, int y) const
+	{
+		SDL_Point world = { x + GetX(), y + GetY() };
+		return world;
+	}
+
+	// Does a world space rect show up on screen?
+	bool IsVisible(const SDL_Rect& rect) const
+	{
+		return rect.x < GetX() + mViewWidth && rect.x + rect.w > GetX() &&
+			rect.y < GetY() + mViewHeight && rect.y + rect.h > GetY();
+	}
+
+private:
+	float mX;
+	float mY;
+	int mViewWidth;
+	int mViewHeight;
+};
@@ -0,0 +1,102 @@
+#include "ChunkRenderCache.h"
+
+#include <string>
+
+// Frames a texture can go unused before it's released
+const Uint32 maxUnusedFrames = 120;
+
+static Uint64 CacheKey(const Chunk& chunk)
+{
+	return (static_cast<Uint64>(static_cast<Uint32>(chunk.chunkX)) << 32) | static_cast<Uint32>(chunk.chunkY);
+}
+
+ChunkRenderCache::ChunkRenderCache()
+{
+	mFrame = 0;
+}
+
+ChunkRenderCache::~ChunkRenderCache()
+{
+	Clear();
+}
+
+bool ChunkRenderCache::IsSupported(SDL_Renderer* renderer) const
+{
+	return SDL_RenderTargetSupported(renderer) == SDL_TRUE;
+}
+
+SDL_Texture* ChunkRenderCache::GetTexture(const Chunk& chunk, RenderLayers& layers, BlockBatcher& batcher)
+{
+	CachedChunk& cached = mTextures[CacheKey(chunk)];
+	cached.lastUsedFrame = mFrame;
+
+	if (!cached.texture) {
+		// Cells get blown up to mGridSize pixels, keep them sharp
+		// SDL_SetHint frees the old value string, so keep a copy to restore
+		const char* currentQuality = SDL_GetHint(SDL_HINT_RENDER_SCALE_QUALITY);
+		const bool qualityWasSet = currentQuality != nullptr;
+		const std::string oldQuality = qualityWasSet ? currentQuality : "";
+		SDL_SetHint(SDL_HINT_RENDER_SCALE_QUALITY, "0");
+		cached.texture = SDL_CreateTexture(layers.GetRenderer(), SDL_PIXELFORMAT_RGBA8888,
+			SDL_TEXTUREACCESS_TARGET, chunkSize, chunkSize);
+		// SDL can't unset a hint; one that was unset stays "0", which is also its default
+		if (qualityWasSet) {
+			SDL_SetHint(SDL_HINT_RENDER_SCALE_QUALITY, oldQuality.c_str());
+		}
+
+		if (!cached.texture) {
+			SDL_Log("Failed to create chunk texture: %s", SDL_GetError());
+			return nullptr;
+		}
+		SDL_SetTextureBlendMode(cached.texture, SDL_BLENDMODE_BLEND);
+		cached.revision = chunk.revision - 1; // Force a redraw
+	}
+
+	if (cached.revision != chunk.revision) {
+		// Redraw the chunk, one texel per cell, empty cells transparent
+		SDL_Texture* oldTarget = layers.GetTarget();
+		layers.SetTarget(cached.texture);
+		layers.SetDrawColor(0, 0, 0, 0);
+		layers.Clear();
+
+		for (int y = 0; y < chunkSize; ++y) {
+			const BlockId* row = &chunk.blocks[y * chunkSize];
+			for (int x = 0; x < chunkSize; ++x) {
+				if (row[x] != emptyBlock) {
+					SDL_Rect cellRect = { x, y, 1, 1 };
+					batcher.Add(row[x], cellRect);
+				}
+			}
+		}
+		batcher.Flush(layers);
+
+		layers.SetTarget(oldTarget);
+		cached.revision = chunk.revision;
+	}
+
+	return cached.texture;
+}
+
+void ChunkRenderCache::EndFrame()
+{
+	for (auto iter = mTextures.begin(); iter != mTextures.end();) {
+		if (mFrame - iter->second.lastUsedFrame > maxUnusedFrames) {
+			SDL_DestroyTexture(iter->second.texture);
+			iter = mTextures.erase(iter);
+		}
+		else {
+			++iter;
+		}
+	}
+	++mFrame;
+}
+
+void ChunkRenderCache::Clear()
+{
+	for (auto& entry : mTextures) {
+		if (entry.second.texture) {
+			SDL_DestroyTexture(entry.second.texture);
+		}
+	}
+	mTextures.clear();
+}
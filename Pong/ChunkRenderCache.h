@@ -0,0 +1,42 @@
+#pragma once
+#include "BlockBatcher.h"
+#include "RenderLayers.h"
+#include "World.h"
+
+#include <unordered_map>
+
+// Keeps a render target texture per visible chunk, one texel per cell.
+// A chunk's texture is only redrawn when its revision changes (a block in it
+// was placed or removed), otherwise drawing the world is one scaled
+// SDL_RenderCopy per visible chunk, no matter how many blocks are in it.
+class ChunkRenderCache
+{
+public:
+	ChunkRenderCache();
+	~ChunkRenderCache();
+
+	// Render targets aren't available on every renderer; fall back to
+	// drawing blocks directly when this is false
+	bool IsSupported(SDL_Renderer* renderer) const;
+
+	// Texture for a chunk, redrawn first if the chunk changed since last time
+	SDL_Texture* GetTexture(const Chunk& chunk, RenderLayers& layers, BlockBatcher& batcher);
+
+	// Release textures that haven't been drawn for a while (chunks that went
+	// off screen or were freed)
+	void EndFrame();
+
+	// Drop every texture (on shutdown, or when the renderer lost its targets)
+	void Clear();
+
+private:
+	struct CachedChunk
+	{
+		SDL_Texture* texture;
+		Uint32 revision;
+		Uint32 lastUsedFrame;
+	};
+
+	std::unordered_map<Uint64, CachedChunk> mTextures;
+	Uint32 mFrame;
+};
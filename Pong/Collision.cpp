@@ -0,0 +1,44 @@
+#include "Collision.h"
+
+#include <algorithm>
+
+bool CheckCollision(const SDL_Rect& a, const SDL_Rect& b) {
+	// Check if two rectangles intersect
+	return (a.x < b.x + b.w) &&
+		(a.x + a.w > b.x) &&
+		(a.y < b.y + b.h) &&
+		(a.y + a.h > b.y);
+}
+
+CellRange GetOverlappingCells(const SDL_Rect& rect, int cellSize)
+{
+	CellRange range;
+
+	// Empty rects can't overlap anything
+	if (rect.w <= 0 || rect.h <= 0) {
+		range.minX = range.minY = 0;
+		range.maxX = range.maxY = -1;
+		return range;
+	}
+
+	// Cell x overlaps when x * size < rect.x + rect.w and x * size + size > rect.x
+	range.minX = FloorDiv(rect.x, cellSize);
+	range.minY = FloorDiv(rect.y, cellSize);
+	range.maxX = FloorDiv(rect.x + rect.w - 1, cellSize);
+	range.maxY = FloorDiv(rect.y + rect.h - 1, cellSize);
+
+	return range;
+}
+
+CellRange GetOverlappingCells(const SDL_Rect& rect, int cellSize, int gridWidth, int gridHeight)
+{
+	CellRange range = GetOverlappingCells(rect, cellSize);
+
+	// Clamp to the grid
+	range.minX = std::max(range.minX, 0);
+	range.minY = std::max(range.minY, 0);
+	range.maxX = std::min(range.maxX, gridWidth - 1);
+	range.maxY = std::min(range.maxY, gridHeight - 1);
+
+	return range;
+}
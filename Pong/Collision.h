@@ -0,0 +1,36 @@
+#pragma once
+#include "SDL/SDL.h"
+
+// Inclusive range of grid cell coordinates
+// (empty when minX > maxX or minY > maxY)
+struct CellRange
+{
+	int minX;
+	int minY;
+	int maxX;
+	int maxY;
+
+	bool IsEmpty() const { return minX > maxX || minY > maxY; }
+};
+
+// Integer division that rounds towards negative infinity, so negative
+// world coordinates map to the right cell/chunk
+inline int FloorDiv(int a, int b)
+{
+	int q = a / b;
+	if ((a % b != 0) && ((a < 0) != (b < 0))) {
+		--q;
+	}
+	return q;
+}
+
+// Check if two rectangles intersect
+bool CheckCollision(const SDL_Rect& a, const SDL_Rect& b);
+
+// Get the grid cells a rectangle overlaps (cells can be negative, the world is unbounded).
+// Uses the same strict edge test as CheckCollision, so a rect that only touches
+// a cell's edge does not include that cell.
+CellRange GetOverlappingCells(const SDL_Rect& rect, int cellSize);
+
+// Same as above, clamped to a gridWidth x gridHeight grid starting at cell 0, 0
+CellRange GetOverlappingCells(const SDL_Rect& rect, int cellSize, int gridWidth, int gridHeight);
@@ -0,0 +1,137 @@
+#include "Entities.h"
+#include "Collision.h"
+#include "FrameArena.h"
+#include "JobSystem.h"
+#include "SpatialHash.h"
+
+Entity EntityRegistry::Create()
+{
+	Entity entity;
+	if (!mFreeSlots.empty()) {
+		entity.index = mFreeSlots.back();
+		mFreeSlots.pop_back();
+	}
+	else {
+		entity.index = static_cast<Uint32>(mGenerations.size());
+		mGenerations.push_back(0);
+	}
+	entity.generation = mGenerations[entity.index];
+	++mAliveCount;
+	return entity;
+}
+
+void EntityRegistry::Destroy(Entity entity)
+{
+	if (!IsAlive(entity)) {
+		return;
+	}
+
+	transforms.Remove(entity);
+	velocities.Remove(entity);
+	sprites.Remove(entity);
+	viewWraps.Remove(entity);
+
+	++mGenerations[entity.index]; // Outstanding handles go stale
+	mFreeSlots.push_back(entity.index);
+	--mAliveCount;
+}
+
+void EntityRegistry::Reserve(int entityCount)
+{
+	mGenerations.reserve(entityCount);
+	mFreeSlots.reserve(entityCount);
+	transforms.Reserve(entityCount);
+	velocities.Reserve(entityCount);
+	sprites.Reserve(entityCount);
+	viewWraps.Reserve(entityCount);
+}
+
+bool EntityRegistry::IsAlive(Entity entity) const
+{
+	return entity.index < mGenerations.size() && mGenerations[entity.index] == entity.generation;
+}
+
+void SavePreviousPositions(EntityRegistry& registry)
+{
+	// Only entities with a velocity move, the rest keep prevPosition == position
+	for (int i = 0; i < registry.velocities.GetCount(); ++i) {
+		Transform* transform = registry.transforms.Find(registry.velocities.GetEntity(i));
+		if (transform) {
+			transform->prevPosition = transform->position;
+		}
+	}
+}
+
+void MoveEntities(EntityRegistry& registry, float deltaTime, JobSystem& jobs)
+{
+	ComponentArray<Velocity>& velocities = registry.velocities;
+	ComponentArray<Transform>& transforms = registry.transforms;
+	const int count = velocities.GetCount();
+
+	// Every velocity belongs to a different entity, so batches never share a transform
+	jobs.ParallelFor(count, jobs.GetBatchSize(count, 1024), [&](int begin, int end) {
+		for (int i = begin; i < end; ++i) {
+			Transform* transform = transforms.Find(velocities.GetEntity(i));
+			if (transform) {
+				const Velocity& velocity = velocities.Get(i);
+				transform->position.x += velocity.x * deltaTime;
+				transform->position.y += velocity.y * deltaTime;
+			}
+		}
+	});
+}
+
+void WrapEntities(EntityRegistry& registry, float viewLeft, float viewRight)
+{
+	for (int i = 0; i < registry.viewWraps.GetCount(); ++i) {
+		Transform* transform = registry.transforms.Find(registry.viewWraps.GetEntity(i));
+		if (!transform) {
+			continue;
+		}
+
+		const float width = registry.viewWraps.Get(i).width;
+		if (transform->position.x > viewRight) { // Moved off the right side
+			transform->position.x = viewLeft - width; // Reset to left side
+			transform->prevPosition = transform->position; // Don't interpolate the jump
+		}
+		else if (transform->position.x < viewLeft - width) { // The camera left it behind
+			transform->position.x = viewRight; // Reset to right side
+			transform->prevPosition = transform->position;
+		}
+	}
+}
+
+PoolHandle SpawnPickup(PickupPool& pickups, SpatialHash& pickupCells, const Vector2& position, BlockId block)
+{
+	PoolHandle handle = pickups.Create({ position, block });
+	if (handle != nullPoolHandle) {
+		pickupCells.Insert(handle, position);
+	}
+	return handle;
+}
+
+void CollectPickups(PickupPool& pickups, SpatialHash& pickupCells, const SDL_Rect& rect, int pickupSize, int maxCount,
+	std::vector<BlockId>& collected, FrameArena& arena)
+{
+	// Pickups are bucketed by their top left corner, so also look one pickup up and left
+	SDL_Rect area = { rect.x - pickupSize, rect.y - pickupSize, rect.w + pickupSize, rect.h + pickupSize };
+	FrameVector<PoolHandle> nearby{ ArenaAllocator<PoolHandle>(arena) };
+	pickupCells.Query(area, nearby);
+
+	int count = 0;
+	for (size_t i = 0; i < nearby.size() && count < maxCount; ++i) {
+		const PoolHandle handle = nearby[i];
+		const Pickup* pickup = pickups.Get(handle);
+		if (!pickup) {
+			continue;
+		}
+
+		SDL_Rect pickupRect = { static_cast<int>(pickup->position.x), static_cast<int>(pickup->position.y), pickupSize, pickupSize };
+		if (CheckCollision(rect, pickupRect)) {
+			collected.push_back(pickup->block);
+			pickupCells.Remove(handle);
+			pickups.Destroy(handle);
+			++count;
+		}
+	}
+}
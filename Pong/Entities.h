@@ -0,0 +1,190 @@
+#pragma once
+#include "SDL/SDL.h"
+#include "Pool.h"
+#include "Vector2.h"
+#include "World.h"
+
+#include <vector>
+
+class FrameArena;
+class JobSystem;
+class SpatialHash;
+
+// Handle to an entity. The index picks a slot, the generation tells a live
+// entity apart from an older one that used the same slot, so a stale handle
+// never reaches the new occupant.
+struct Entity
+{
+	Uint32 index;
+	Uint32 generation;
+
+	bool operator==(const Entity& other) const { return index == other.index && generation == other.generation; }
+	bool operator!=(const Entity& other) const { return !(*this == other); }
+};
+
+const Entity nullEntity = { 0xFFFFFFFF, 0 };
+
+// Components
+
+struct Transform
+{
+	Vector2 position;
+	Vector2 prevPosition; // At the previous simulation step (for interpolation)
+};
+
+struct Velocity
+{
+	float x;
+	float y;
+};
+
+// Textured quad, texture is an index into the game's sprite textures
+struct Sprite
+{
+	int texture;
+	int width;
+	int height;
+};
+
+// Wraps around the horizontal view (clouds), width is how far off screen
+// the entity has to be before it comes back on the other side
+struct ViewWrap
+{
+	float width;
+};
+
+// One component type for every entity that has it, packed into a dense
+// array. A sparse table maps entity slots to array positions; removal
+// moves the last component into the hole, so the array never has gaps
+// and systems only ever walk live components.
+template <typename T>
+class ComponentArray
+{
+public:
+	T& Add(Entity entity, const T& component)
+	{
+		SDL_assert(!Find(entity));
+		if (entity.index >= mSparse.size()) {
+			mSparse.resize(entity.index + 1, -1);
+		}
+		mSparse[entity.index] = static_cast<int>(mDense.size());
+		mDense.push_back(component);
+		mEntities.push_back(entity);
+		return mDense.back();
+	}
+
+	void Remove(Entity entity)
+	{
+		if (!Find(entity)) {
+			return;
+		}
+		const int hole = mSparse[entity.index];
+		const int last = static_cast<int>(mDense.size()) - 1;
+		mDense[hole] = mDense[last];
+		mEntities[hole] = mEntities[last];
+		mSparse[mEntities[hole].index] = hole;
+		mSparse[entity.index] = -1;
+		mDense.pop_back();
+		mEntities.pop_back();
+	}
+
+	T* Find(Entity entity)
+	{
+		return const_cast<T*>(static_cast<const ComponentArray*>(this)->Find(entity));
+	}
+
+	const T* Find(Entity entity) const
+	{
+		if (entity.index >= mSparse.size()) {
+			return nullptr;
+		}
+		const int dense = mSparse[entity.index];
+		if (dense < 0 || mEntities[dense] != entity) {
+			return nullptr;
+		}
+		return &mDense[dense];
+	}
+
+	void Reserve(int count)
+	{
+		mDense.reserve(count);
+		mEntities.reserve(count);
+		mSparse.reserve(count);
+	}
+
+	void Clear()
+	{
+		mDense.clear();
+		mEntities.clear();
+		mSparse.clear();
+	}
+
+	// Dense arrays, GetEntity(i) owns Get(i)
+	int GetCount() const { return static_cast<int>(mDense.size()); }
+	T& Get(int i) { return mDense[i]; }
+	const T& Get(int i) const { return mDense[i]; }
+	Entity GetEntity(int i) const { return mEntities[i]; }
+
+private:
+	std::vector<T> mDense;
+	std::vector<Entity> mEntities;
+	std::vector<int> mSparse; // Entity index -> position in mDense, -1 for none
+};
+
+// Creates and destroys entities and owns every component array
+class EntityRegistry
+{
+public:
+	Entity Create();
+	void Destroy(Entity entity); // Also removes its components
+	bool IsAlive(Entity entity) const;
+
+	// Make room for entityCount entities (with every component) up front,
+	// so creating and destroying up to that many never reallocates
+	void Reserve(int entityCount);
+	int GetAliveCount() const { return mAliveCount; }
+
+	ComponentArray<Transform> transforms;
+	ComponentArray<Velocity> velocities;
+	ComponentArray<Sprite> sprites;
+	ComponentArray<ViewWrap> viewWraps;
+
+private:
+	std::vector<Uint32> mGenerations; // Current generation of each slot
+	std::vector<Uint32> mFreeSlots;
+	int mAliveCount = 0;
+};
+
+// Systems, each walks only the component arrays it needs
+
+// Remember every moving entity's position before a simulation step
+void SavePreviousPositions(EntityRegistry& registry);
+
+// position += velocity * deltaTime, split across the job system
+void MoveEntities(EntityRegistry& registry, float deltaTime, JobSystem& jobs);
+
+// Bring ViewWrap entities that left [viewLeft, viewRight] back on the other side
+void WrapEntities(EntityRegistry& registry, float viewLeft, float viewRight);
+
+// Block pickups lying in the world. They don't move and come and go in
+// bulk, so they live in a fixed Pool rather than the entity registry:
+// spawning and collecting them never touches the heap.
+struct Pickup
+{
+	Vector2 position;
+	BlockId block;
+};
+
+typedef Pool<Pickup> PickupPool;
+
+// Pickups are also kept in a SpatialHash, so they have to be created and
+// destroyed through these two
+
+// nullPoolHandle when the pool is full
+PoolHandle SpawnPickup(PickupPool& pickups, SpatialHash& pickupCells, const Vector2& position, BlockId block);
+
+// Destroy up to maxCount pickups overlapping rect and append their blocks to
+// collected; pickups are pickupSize squares at their position. Only the
+// hash cells around rect are visited, the candidates go into arena.
+void CollectPickups(PickupPool& pickups, SpatialHash& pickupCells, const SDL_Rect& rect, int pickupSize, int maxCount,
+	std::vector<BlockId>& collected, FrameArena& arena);
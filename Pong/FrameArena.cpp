@@ -0,0 +1,58 @@
+#include "FrameArena.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <new>
+
+FrameArena::FrameArena(size_t capacity)
+	: mMemory(static_cast<char*>(::operator new(capacity)))
+	, mCapacity(capacity)
+	, mUsed(0)
+	, mLastFrameUsed(0)
+	, mHighWater(0)
+	, mOverflowCount(0)
+{
+}
+
+FrameArena::~FrameArena()
+{
+	::operator delete(mMemory);
+}
+
+void* FrameArena::Allocate(size_t size, size_t alignment)
+{
+	// Align the address, not just the offset (the block is only as aligned as new made it)
+	const uintptr_t address = reinterpret_cast<uintptr_t>(mMemory) + mUsed;
+	const size_t padding = (alignment - address % alignment) % alignment;
+	if (mUsed + padding + size > mCapacity) {
+		mOverflowCount.fetch_add(1, std::memory_order_relaxed);
+		return ::operator new(size);
+	}
+
+	void* memory = mMemory + mUsed + padding;
+	mUsed += padding + size;
+	return memory;
+}
+
+void FrameArena::Free(void* memory)
+{
+	char* bytes = static_cast<char*>(memory);
+	if (bytes < mMemory || bytes >= mMemory + mCapacity) {
+		::operator delete(memory);
+	}
+}
+
+void FrameArena::Reset()
+{
+	mLastFrameUsed.store(mUsed, std::memory_order_relaxed);
+	if (mUsed > mHighWater.load(std::memory_order_relaxed)) {
+		mHighWater.store(mUsed, std::memory_order_relaxed);
+	}
+
+#ifndef NDEBUG
+	// Make anything that held on to last frame's memory fail loudly
+	memset(mMemory, 0xCD, mUsed);
+#endif
+	mUsed = 0;
+}
@@ -0,0 +1,83 @@
+#pragma once
+#include "SDL/SDL.h"
+
+#include <atomic>
+#include <cstddef>
+#include <vector>
+
+// Bump allocator for data that only lives for one frame (query results,
+// visible chunk lists). Allocating moves a pointer through one block
+// reserved up front, freeing does nothing, and Reset at the top of the
+// frame makes the whole block available again. Each thread that runs a
+// frame loop owns its own arena; nothing allocated from it may be kept
+// past the next Reset.
+//
+// When the block runs out, allocations fall back to the heap (counted as
+// overflows) so a busy frame is slower rather than broken.
+class FrameArena
+{
+public:
+	explicit FrameArena(size_t capacity);
+	~FrameArena();
+
+	FrameArena(const FrameArena&) = delete;
+	FrameArena& operator=(const FrameArena&) = delete;
+
+	void* Allocate(size_t size, size_t alignment);
+	void Free(void* memory); // Only heap fallbacks are really freed
+
+	// Start a new frame, everything allocated so far is gone
+	void Reset();
+
+	// Readable from any thread (the overlay shows the simulation's arena)
+	size_t GetCapacity() const { return mCapacity; }
+	size_t GetLastFrameUsed() const { return mLastFrameUsed.load(std::memory_order_relaxed); }
+	size_t GetHighWater() const { return mHighWater.load(std::memory_order_relaxed); }
+	int GetOverflowCount() const { return mOverflowCount.load(std::memory_order_relaxed); }
+
+private:
+	char* mMemory;
+	size_t mCapacity;
+	size_t mUsed;
+	std::atomic<size_t> mLastFrameUsed; // Bytes used by the frame before the last Reset
+	std::atomic<size_t> mHighWater;     // Most bytes any frame used
+	std::atomic<int> mOverflowCount;    // Heap fallbacks since startup
+};
+
+// Standard allocator on top of a FrameArena, for containers that are
+// built and thrown away within one frame:
+//     FrameVector<Entity> nearby{ ArenaAllocator<Entity>(arena) };
+template <typename T>
+class ArenaAllocator
+{
+public:
+	typedef T value_type;
+
+	explicit ArenaAllocator(FrameArena& arena) : mArena(&arena) {}
+
+	template <typename U>
+	ArenaAllocator(const ArenaAllocator<U>& other) : mArena(other.GetArena()) {}
+
+	T* allocate(size_t count)
+	{
+		return static_cast<T*>(mArena->Allocate(count * sizeof(T), alignof(T)));
+	}
+
+	void deallocate(T* memory, size_t)
+	{
+		mArena->Free(memory);
+	}
+
+	FrameArena* GetArena() const { return mArena; }
+
+private:
+	FrameArena* mArena;
+};
+
+template <typename T, typename U>
+bool operator==(const ArenaAllocator<T>& a, const ArenaAllocator<U>& b) { return a.GetArena() == b.GetArena(); }
+template <typename T, typename U>
+bool operator!=(const ArenaAllocator<T>& a, const ArenaAllocator<U>& b) { return a.GetArena() != b.GetArena(); }
+
+template <typename T>
+using FrameVector = std::vector<T, ArenaAllocator<T>>;
@@ -0,0 +1,70 @@
+#include "FrameScheduler.h"
+
+#include <algorithm>
+
+FrameScheduler::FrameScheduler()
+{
+	mFrequency = SDL_GetPerformanceFrequency();
+	mLastFrame = SDL_GetPerformanceCounter();
+	mDeadline = mLastFrame;
+	mSleepError = mFrequency / 1000; // Start by assuming a 1 ms timer
+	SetTargetRate(60);
+}
+
+void FrameScheduler::SetTargetRate(int framesPerSecond)
+{
+	mTargetRate = std::max(0, framesPerSecond);
+	mFrameTicks = mTargetRate > 0 ? mFrequency / mTargetRate : 0;
+	mDeadline = SDL_GetPerformanceCounter() + mFrameTicks;
+}
+
+float FrameScheduler::WaitForNextFrame()
+{
+	if (mFrameTicks > 0) {
+		SleepUntil(mDeadline);
+
+		// Schedule from the deadline rather than from now so frames don't
+		// drift, unless we fell more than a frame behind
+		const Uint64 now = SDL_GetPerformanceCounter();
+		mDeadline += mFrameTicks;
+		if (now > mDeadline) {
+			mDeadline = now + mFrameTicks;
+		}
+	}
+
+	const Uint64 now = SDL_GetPerformanceCounter();
+	const float deltaTime = static_cast<float>(now - mLastFrame) / mFrequency;
+	mLastFrame = now;
+	return deltaTime;
+}
+
+void FrameScheduler::SleepUntil(Uint64 deadline)
+{
+	const Uint64 ticksPerMs = mFrequency / 1000;
+
+	// Sleep in whole milliseconds, leaving room for the usual oversleep
+	Uint64 now = SDL_GetPerformanceCounter();
+	while (now + mSleepError < deadline) {
+		const Uint64 sleepTicks = deadline - now - mSleepError;
+		const Uint32 sleepMs = static_cast<Uint32>(sleepTicks / ticksPerMs);
+		if (sleepMs == 0) {
+			break;
+		}
+
+		SDL_Delay(sleepMs);
+
+		// Track how far past the request the OS woke us, easing back down
+		// slowly so one bad wakeup doesn't turn into spinning forever
+		const Uint64 woke = SDL_GetPerformanceCounter();
+		const Uint64 slept = woke - now;
+		const Uint64 requested = sleepMs * ticksPerMs;
+		const Uint64 error = slept > requested ? slept - requested : 0;
+		mSleepError = std::max(error, mSleepError - mSleepError / 16);
+		mSleepError = std::min(mSleepError, 4 * ticksPerMs);
+		now = woke;
+	}
+
+	// Spin for whatever is left (normally under a millisecond)
+	while (SDL_GetPerformanceCounter() < deadline)
+		;
+}
@@ -0,0 +1,28 @@
+#pragma once
+#include "SDL/SDL.h"
+
+// Paces the game loop to a target frame rate without burning a core.
+// Most of the wait is spent in SDL_Delay; only the last stretch (about the
+// size of the OS sleep error) is spun on SDL_GetPerformanceCounter.
+class FrameScheduler
+{
+public:
+	FrameScheduler();
+
+	// Frames per second to run at, 0 for uncapped
+	void SetTargetRate(int framesPerSecond);
+	int GetTargetRate() const { return mTargetRate; }
+
+	// Wait until the next frame is due, return seconds since the previous one
+	float WaitForNextFrame();
+
+private:
+	void SleepUntil(Uint64 deadline);
+
+	int mTargetRate;
+	Uint64 mFrequency;  // Performance counter ticks per second
+	Uint64 mFrameTicks; // Performance counter ticks per frame (0 when uncapped)
+	Uint64 mDeadline;   // When the next frame is due
+	Uint64 mLastFrame;  // When the previous frame started
+	Uint64 mSleepError; // How late SDL_Delay tends to wake up, in counter ticks
+};
@@ -1,11 +1,22 @@
 // One block = 50 pixel
 
 #include "Game.h"
+#include "AllocationCounter.h"
+#include "AudioConvert.h"
+#include "Camera.h"
+#include "Collision.h"
+#include "Entities.h"
+#include "SpatialHash.h"
+#include "TripleBuffer.h"
+#include "World.h"
+
+#include <cstdio>
 
 const int thickness = 15;
 
 struct Player {
 	Vector2 mPos;
+	Vector2 mPrevPos; // Position at the previous simulation step (for interpolation)
 	int mWidth;
 	int mHeight;
 	float mVelY;
@@ -15,7 +26,6 @@ struct Player {
 	bool facingRight;	
 
 	// Animation fields
-	SDL_Texture* spriteSheet;
 	int frameWidth;
 	int frameHeight;
 	int currentFrame;
@@ -23,49 +33,22 @@ struct Player {
 };
 
 
-struct Block {
-	bool isActive;
-	SDL_Color color;
-};
-
 struct Inventory {
-	std::vector<Block> blocks;
+	std::vector<BlockId> blocks;
 	int maxCapacity = 64;
 	int selectedIndex = 0;
 };
 
-struct BlockPickup {
-	Vector2 position;
-	Block block;
-	bool isActive;
-};
-
-struct Cloud {
-	Vector2 position;
-	int width;
-	int height;
-	SDL_Texture* texture;
-	float speed;  // Speed of the cloud
-};
+// Game state below is owned by the simulation thread, GenerateOutput only
+// sees it through GameSnapshot
 
 Player mPlayer;
 SDL_Rect playerRect;
 SDL_Rect groundRect;
 Inventory mInventory;
-std::vector<BlockPickup> mBlockPickups;
-std::vector<Cloud> clouds;
-
-const SDL_Color blockColors[9] = {
-	{255, 255, 255, 255}, // White
-	{192, 192, 192, 255}, // Light Gray
-	{128, 128, 128, 255}, // Gray
-	{64, 64, 64, 255},    // Dark Gray
-	{255, 0, 0, 255},     // Red
-	{0, 255, 0, 255},     // Green
-	{0, 0, 255, 255},     // Blue
-	{255, 255, 0, 255},   // Yellow
-	{0, 0, 0, 255}        // Black
-};
+EntityRegistry mEntities; // Clouds
+PickupPool mPickups(0); // Block pickups, sized in Initialize
+SpatialHash mPickupCells(100); // Every pickup in mPickups, by position
 
 
 
@@ -74,9 +57,54 @@ bool mShowGrid = true;
 int mGridSize = 50; // Grid cell size
 
 // Block variables
-const int gridWidth = 1024 / 50; // Assuming grid size of 50
-const int gridHeight = 768 / 50;
-std::vector<std::vector<Block>> gridBlocks(gridWidth, std::vector<Block>(gridHeight, { false, {128, 0, 128, 255} })); // Initialize all blocks as inactive
+World mWorld; // Chunked and unbounded, starts out empty
+World mRenderWorld; // The render thread's copy of mWorld, updated from BlockChanges
+
+// Camera variables
+Camera mCamera(1024, 768); // View is the size of the window
+Camera mSimCamera(1024, 768); // Same view on the simulation thread, for mouse picking
+
+// A block placed or removed by the simulation, replayed into mRenderWorld
+struct BlockChange {
+	Uint32 sequence;
+	int x;
+	int y;
+	BlockId block;
+};
+
+// A sprite entity as GenerateOutput draws it
+struct SpriteDraw {
+	int texture;
+	Vector2 prevPosition;
+	Vector2 position;
+	int width;
+	int height;
+};
+
+// A pickup near the view
+struct PickupDraw {
+	Vector2 position;
+	BlockId block;
+};
+
+// Everything GenerateOutput draws, copied out of the simulation after every frame
+struct GameSnapshot {
+	Player player;
+	std::vector<SpriteDraw> sprites;
+	std::vector<PickupDraw> pickups; // Only the ones around the view, there can be lots
+	std::vector<BlockId> inventory;
+	int selectedIndex;
+	int gridSize;
+	float interpolation;
+	SDL_Color highlightColor;
+	std::vector<BlockChange> blockChanges; // Every change the render thread hasn't applied yet
+};
+
+// Simulation to render thread handoff
+TripleBuffer<GameSnapshot> snapshots;
+std::vector<BlockChange> pendingBlockChanges; // Resent with each snapshot until applied
+Uint32 blockChangeSequence = 0;
+std::atomic<Uint32> renderedBlockChange(0); // Last change applied to mRenderWorld
 
 // Inventory variables
 const int invGridSize = 50; // Size of each inventory grid cell
@@ -87,22 +115,78 @@ const int invGridYPos = 768 - invGridSize; // Y position of inventory grid
 // World variables
 const int groundHeight = 168; // You can adjust this value as needed
 
-// Collision Check, Check if two rectangles intersect
-bool CheckCollision(const SDL_Rect& a, const SDL_Rect& b) {
-	// Check if two rectangles intersect
-	return (a.x < b.x + b.w) &&
-		(a.x + a.w > b.x) &&
-		(a.y < b.y + b.h) &&
-		(a.y + a.h > b.y);
+// Trace capture from the F4 key
+const char* const traceHotkeyPath = "trace.json";
+const int traceHotkeyFrames = 300; // About 5 seconds at 60 fps
+
+// Simulation variables
+const float simTimeStep = 1.0f / 120.0f; // The simulation always advances in steps of this size
+const float maxFrameTime = 0.25f; // Longer frames (debugger breaks etc.) only simulate this much
+
+// Linear interpolation between two positions
+Vector2 Lerp(const Vector2& a, const Vector2& b, float t)
+{
+	return { a.x + (b.x - a.x) * t, a.y + (b.y - a.y) * t };
+}
+
+// Center a camera on the player where it's drawn (between the last two steps)
+void FollowPlayer(Camera& camera, const Player& player, float interpolation)
+{
+	Vector2 playerPos = Lerp(player.mPrevPos, player.mPos, interpolation);
+	camera.Follow(playerPos.x + player.mWidth / 2.0f, playerPos.y + player.mHeight / 2.0f);
+}
+
+// "last frame / peak / capacity" for the overlay, plus heap fallbacks if there were any
+std::string FormatArenaUsage(const FrameArena& arena)
+{
+	char text[96];
+	snprintf(text, sizeof(text), "%.1f / %.1f / %u KB", arena.GetLastFrameUsed() / 1024.0,
+		arena.GetHighWater() / 1024.0, static_cast<unsigned>(arena.GetCapacity() / 1024));
+	std::string usage = text;
+	if (arena.GetOverflowCount() > 0) {
+		usage += ", " + std::to_string(arena.GetOverflowCount()) + " overflows";
+	}
+	return usage;
+}
+
+// Change a block in the simulation's world and queue it for the render thread
+void SetBlock(int x, int y, BlockId block)
+{
+	if (mWorld.Get(x, y) == block) {
+		return;
+	}
+	mWorld.Set(x, y, block);
+	pendingBlockChanges.push_back({ ++blockChangeSequence, x, y, block });
 }
 
 
+// Bytes of per-frame temporaries for each thread
+const size_t frameArenaSize = 256 * 1024;
+
 Game::Game()
+	: mFrameArena(frameArenaSize)
+	, mSimArena(frameArenaSize)
 {
 	mWindow = nullptr;
 	mRenderer = nullptr;
-	mTicksCount = 0;
 	mIsRunning = true;
+	mAccumulator = 0.0f;
+	mInterpolation = 0.0f;
+	mHeadless = false;
+	mHeadlessFrames = 0;
+	mStartupStart = 0;
+	mStartupTime = 0.0;
+	mAssetsLoadedTime = -1.0;
+	mStartupResident = 0;
+	mFrameTime = 0.0f;
+	mSeed = 1; // Same clouds as the unseeded rand() used to give
+	mPickupCount = 0;
+	mUseChunkCache = false;
+	mSimThread = nullptr;
+	mSimWake = nullptr;
+	mSimQuit = false;
+	mPlayerSprite = nullAsset;
+	mJumpAsset = nullAsset;
 
 	highlightColor = { 255, 255, 255, 255 };
 	highlightColorChangeDirection = 1;
@@ -111,6 +195,16 @@ Game::Game()
 
 bool Game::Initialize()
 {
+	mStartupStart = SDL_GetPerformanceCounter();
+	Profiler::Get().SetThreadName("Main");
+
+	// Headless runs use SDL's dummy drivers, no window or sound card needed
+	if (mHeadless)
+	{
+		SDL_setenv("SDL_VIDEODRIVER", "dummy", 1);
+		SDL_setenv("SDL_AUDIODRIVER", "dummy", 1);
+	}
+
 	// Initialize SDL
 	int sdlResult = SDL_Init(SDL_INIT_VIDEO);
 	if (sdlResult != 0)
@@ -139,7 +233,7 @@ bool Game::Initialize()
 	mRenderer = SDL_CreateRenderer(
 		mWindow, // Window to create renderer for
 		-1,		 // Usually -1
-		SDL_RENDERER_ACCELERATED | SDL_RENDERER_PRESENTVSYNC
+		mHeadless ? SDL_RENDERER_SOFTWARE : SDL_RENDERER_ACCELERATED | SDL_RENDERER_PRESENTVSYNC
 	);
 
 	if (!mRenderer)
@@ -147,17 +241,29 @@ bool Game::Initialize()
 		SDL_Log("Failed to create renderer: %s", SDL_GetError());
 		return false;
 	}
+	mLayers.SetRenderer(mRenderer);
+	mUseChunkCache = mChunkCache.IsSupported(mRenderer);
+	mProfilerOverlay.Initialize();
+	mJobs.Initialize();
+	BuildUpdateGraph();
 
 	// Initialize sounds
-	Mix_OpenAudio(44100, MIX_DEFAULT_FORMAT, 2, 2400);
-	mSoundtrack = Mix_LoadWAV("Chiptune.wav");
-	mJump = Mix_LoadWAV("se_jump_003.wav");
+	Mix_OpenAudio(audioFrequency, audioFormat, audioChannels, 2400);
+	if (mArchive.Open("Assets.pak")) {
+		SDL_Log("Loading assets from Assets.pak (%d files)", mArchive.GetEntryCount());
+	}
+	else {
+		SDL_Log("No Assets.pak, loading loose files");
+	}
+	mAssets.Initialize(mRenderer, &mArchive);
+	mJumpSound = mAudio.AddSound(1); // Silent until the asset has loaded
+	mJumpAsset = mAssets.LoadSound("se_jump_003.wav");
+	mAudio.Start(16);
+	mMusic.Initialize("Soundtracks", 2000, &mArchive); // Streamed, 2 second fades between tracks
 
 
 	// Initialize player sprite
-	SDL_Surface* tempSurface = IMG_Load("Idle.png");
-	mPlayer.spriteSheet = SDL_CreateTextureFromSurface(mRenderer, tempSurface);
-	SDL_FreeSurface(tempSurface);
+	mPlayerSprite = mAssets.LoadTexture("Idle.png");
 
 	mPlayer.frameWidth = 128; // Width of each frame
 	mPlayer.frameHeight = 128; // Height of each frame
@@ -173,65 +279,365 @@ bool Game::Initialize()
 	mPlayer.isCrouching = false;
 	mPlayer.isOnGround = true; // Initially, the player is on the ground
 	mPlayer.facingRight = true; // Initially facing 
+	mPlayer.mPrevPos = mPlayer.mPos;
+
+	// Start the camera on the player
+	FollowPlayer(mCamera, mPlayer, 0.0f);
+	FollowPlayer(mSimCamera, mPlayer, 0.0f);
 
 	// Initialize inventory
-	for (int i = 0; i < 9; ++i) {
-		mInventory.blocks.push_back({ true, blockColors[i] });
+	for (BlockId id = 1; id < blockPaletteSize; ++id) {
+		mInventory.blocks.push_back(id);
 	}
 	mInventory.selectedIndex = 0; // Start with the first block selected
 	
 	// Play Soundtrack
-	Mix_PlayChannel(-1, mSoundtrack, 0);
-
-	// Load cloud texture
-	SDL_Surface* cloudSurface = IMG_Load("Clouds.png");
-	SDL_Texture* cloudTexture = SDL_CreateTextureFromSurface(mRenderer, cloudSurface);
-	SDL_FreeSurface(cloudSurface);
+	mMusic.Play();
+
+	// Load cloud texture. Its size is fixed here rather than read from the
+	// texture, which is still loading while the simulation starts.
+	const int cloudSprite = static_cast<int>(mSpriteTextures.size());
+	mSpriteTextures.push_back(mAssets.LoadTexture("Clouds.png"));
+	const int cloudWidth = 2000; // Size of Clouds.png
+	const int cloudHeight = 2000;
+	const float cloudScale = 0.3f; // Clouds are drawn at 30% of the texture size
+
+	// Every entity and pickup there will ever be
+	const int cloudCount = 5;
+	mEntities.Reserve(cloudCount);
+	mPickups = PickupPool(mPickupCount);
+
+	// Initialize clouds (seeded, so recordings replay with the same sky)
+	srand(mSeed);
+	for (int i = 0; i < cloudCount; ++i) {
+		Vector2 position;
+		position.x = static_cast<float>(rand() % 1024);
+		position.y = static_cast<float>(rand() % 200);
+		const float speed = 0.0f + static_cast<float>(rand() % 100);
+
+		Entity cloud = mEntities.Create();
+		mEntities.transforms.Add(cloud, { position, position });
+		mEntities.velocities.Add(cloud, { speed, 0.0f });
+		mEntities.sprites.Add(cloud, { cloudSprite, static_cast<int>(cloudWidth * cloudScale), static_cast<int>(cloudHeight * cloudScale) });
+		mEntities.viewWraps.Add(cloud, { static_cast<float>(cloudWidth) });
+	}
 
-	// Initialize clouds
-	for (int i = 0; i < 5; ++i) {
-		Cloud cloud;
-		cloud.position.x = static_cast<float>(rand() % 1024);
-		cloud.position.y = static_cast<float>(rand() % 200);
-		cloud.speed = 0.0f + static_cast<float>(rand() % 100);
-		cloud.texture = cloudTexture;
-		SDL_QueryTexture(cloud.texture, NULL, NULL, &cloud.width, &cloud.height); // Get width and height from texture
-		clouds.push_back(cloud);
+	// Scatter the --pickups stress test along the ground, after the clouds so
+	// their random numbers are the same as without it
+	for (int i = 0; i < mPickupCount; ++i) {
+		Vector2 position;
+		position.x = static_cast<float>((static_cast<long long>(i) * 7919) % 2000000 - 1000000);
+		position.y = static_cast<float>(768 - groundHeight - mGridSize / 2 - rand() % 400);
+		SpawnPickup(mPickups, mPickupCells, position, static_cast<BlockId>(1 + rand() % (blockPaletteSize - 1)));
 	}
 
+	// Something to draw before the simulation thread finishes its first frame
+	PublishSnapshot();
+
+	mStartupTime = (SDL_GetPerformanceCounter() - mStartupStart) * 1000.0 / SDL_GetPerformanceFrequency();
+	mStartupResident = GetPeakResidentBytes();
 	return true;
 }
 
+void Game::SetTargetFrameRate(int framesPerSecond)
+{
+	mScheduler.SetTargetRate(framesPerSecond);
+}
+
+void Game::SetPickupCount(int count)
+{
+	mPickupCount = std::max(count, 0); // Sizes the pickup pool
+}
+
+void Game::SetSeed(Uint32 seed)
+{
+	mSeed = seed;
+}
+
+bool Game::StartRecording(const char* path)
+{
+	return mInput.StartRecording(path, mSeed);
+}
+
+bool Game::StartReplay(const char* path)
+{
+	return mInput.StartReplay(path, mSeed);
+}
+
+void Game::StartTrace(const char* path, int frameCount)
+{
+	Profiler::Get().StartCapture(path, frameCount);
+}
+
+void Game::SetHeadless(int frameCount)
+{
+	mHeadless = true;
+	mHeadlessFrames = std::max(frameCount, 0);
+	SetTargetFrameRate(0);
+
+	// Replays run "forever" (until the recording ends), don't reserve for that
+	const int reserveFrames = std::min(mHeadlessFrames, 100000);
+	mInputStats.Reserve(reserveFrames);
+	mUpdateStats.Reserve(reserveFrames);
+	mOutputStats.Reserve(reserveFrames);
+}
+
 void Game::RunLoop()
 {
-	while (mIsRunning)
+	const double ticksPerMs = SDL_GetPerformanceFrequency() / 1000.0;
+	int frame = 0;
+
+	// Heap allocations (all threads) once everything has warmed up, for the
+	// headless report of Benchmark builds
+#ifdef PONG_COUNT_ALLOCATIONS
+	const int warmupFrames = 120;
+	Uint64 warmAllocations = 0;
+	Uint64 endAllocations = 0;
+#endif
+
+	if (!StartSimulation())
 	{
+		return;
+	}
+
+	// Headless runs stop after mHeadlessFrames, which may be none at all
+	while (mIsRunning && !(mHeadless && frame >= mHeadlessFrames))
+	{
+		mFrameArena.Reset();
+
+		// Sleep until the next frame is due
+		{
+			PROFILE_ZONE("Wait");
+			mFrameTime = mScheduler.WaitForNextFrame();
+		}
+
+		// Headless runs simulate exactly one 60 Hz frame per loop, as fast as
+		// possible, so every run covers the same simulated time
+		if (mHeadless)
+		{
+			mFrameTime = 1.0f / 60.0f;
+		}
+
+		const Uint64 frameStart = SDL_GetPerformanceCounter();
 		ProcessInput();
-		UpdateGame();
+		if (mInput.IsReplayFinished())
+		{
+			break; // Don't simulate past the end of the recording
+		}
+
+		// Hand the frame to the simulation thread, which runs UpdateGame while
+		// this thread draws the last frame it finished
+		while (!mSimInputQueue.Push(mInputFrame))
+		{
+			SDL_Delay(1); // Simulation is a whole queue behind
+		}
+		SDL_SemPost(mSimWake);
+		const Uint64 inputEnd = SDL_GetPerformanceCounter();
+
 		GenerateOutput();
+		const Uint64 outputEnd = SDL_GetPerformanceCounter();
+		PROFILE_END_FRAME();
+
+		if (mHeadless)
+		{
+			mInputStats.Add((inputEnd - frameStart) / ticksPerMs);
+			mOutputStats.Add((outputEnd - inputEnd) / ticksPerMs);
+
+			++frame;
+#ifdef PONG_COUNT_ALLOCATIONS
+			if (frame == warmupFrames)
+			{
+				warmAllocations = GetAllocationCount();
+			}
+#endif
+		}
+	}
+#ifdef PONG_COUNT_ALLOCATIONS
+	endAllocations = GetAllocationCount();
+#endif
+
+	// Simulates the frames still queued before returning
+	StopSimulation();
+
+	// Final state, for comparing replays of the same recording across builds
+	if (mInput.IsReplaying())
+	{
+		SDL_Log("Replayed %d frames: world checksum %08x, %u chunks, player at %.3f, %.3f",
+			mInput.GetFrameCount(), mWorld.GetChecksum(), static_cast<unsigned>(mWorld.GetChunkCount()),
+			mPlayer.mPos.x, mPlayer.mPos.y);
+	}
+
+	if (mHeadless)
+	{
+		PhaseStats::PrintHeader();
+		mInputStats.Print("ProcessInput");
+		mUpdateStats.Print("UpdateGame"); // Simulation thread
+		mOutputStats.Print("GenerateOutput");
+
+		printf("startup_ms,assets_loaded_ms,startup_peak_rss_kb,run_peak_rss_kb\n");
+		printf("%.3f,%.3f,%u,%u\n", mStartupTime, mAssetsLoadedTime, static_cast<unsigned>(mStartupResident / 1024),
+			static_cast<unsigned>(GetPeakResidentBytes() / 1024));
+
+#ifdef PONG_COUNT_ALLOCATIONS
+		if (frame > warmupFrames)
+		{
+			const int steadyFrames = frame - warmupFrames;
+			printf("allocations,frames,total,per_frame\n");
+			printf("steady_state,%d,%llu,%.3f\n", steadyFrames, static_cast<unsigned long long>(endAllocations - warmAllocations),
+				static_cast<double>(endAllocations - warmAllocations) / steadyFrames);
+		}
+#endif
+	}
+}
+
+bool Game::StartSimulation()
+{
+	mSimQuit = false;
+	mSimWake = SDL_CreateSemaphore(0);
+	mSimThread = SDL_CreateThread(SimulationThread, "Simulation", this);
+	if (!mSimThread)
+	{
+		SDL_Log("Failed to start the simulation thread: %s", SDL_GetError());
+		return false;
+	}
+	return true;
+}
+
+void Game::StopSimulation()
+{
+	if (!mSimThread)
+	{
+		return;
+	}
+
+	mSimQuit = true;
+	SDL_SemPost(mSimWake);
+	SDL_WaitThread(mSimThread, nullptr);
+	mSimThread = nullptr;
+
+	SDL_DestroySemaphore(mSimWake);
+	mSimWake = nullptr;
+}
+
+int SDLCALL Game::SimulationThread(void* game)
+{
+	static_cast<Game*>(game)->RunSimulation();
+	return 0;
+}
+
+void Game::RunSimulation()
+{
+	Profiler::Get().SetThreadName("Simulation");
+	const double ticksPerMs = SDL_GetPerformanceFrequency() / 1000.0;
+
+	// One wake-up per queued frame, plus one to quit once the queue is empty
+	for (;;)
+	{
+		SDL_SemWait(mSimWake);
+		if (!mSimInputQueue.Pop(mSimInput))
+		{
+			if (mSimQuit)
+			{
+				break;
+			}
+			continue;
+		}
+
+		mSimArena.Reset();
+		const Uint64 start = SDL_GetPerformanceCounter();
+		ApplyInput(mSimInput);
+		UpdateGame();
+		PublishSnapshot();
+		mAudio.EndFrame();
+
+		if (mHeadless)
+		{
+			mUpdateStats.Add((SDL_GetPerformanceCounter() - start) / ticksPerMs);
+		}
 	}
 }
 
 void Game::ProcessInput()
 {
-	SDL_Event event;
-	while (SDL_PollEvent(&event)) {
+	PROFILE_ZONE("Input");
+
+	// Get this frame's input, from SDL or from a recording
+	if (!mInput.Poll(mInputFrame, mFrameTime)) {
+		mIsRunning = false; // Replay finished
+		return;
+	}
+
+	// Window events come live from SDL, even during a replay
+	if (mInput.IsQuitRequested()) {
+		mIsRunning = false;
+	}
+	if (mInput.WereRenderTargetsReset()) {
+		mChunkCache.Clear(); // Cached chunk textures lost their contents
+	}
+
+	// Debug keys here, gameplay input goes to the simulation (ApplyInput)
+	for (const InputEvent& event : mInputFrame.events) {
 		switch (event.type) {
-		case SDL_QUIT:
-			mIsRunning = false;
-			break;
 		case SDL_KEYDOWN:
-			if (!event.key.repeat) {
-				if (event.key.keysym.scancode == SDL_SCANCODE_G) {
+			if (!event.repeat) {
+				if (event.scancode == SDL_SCANCODE_G) {
 					mShowGrid = !mShowGrid;
 				}
-				if (event.key.keysym.scancode == SDL_SCANCODE_EQUALS) {
+				if (event.scancode == SDL_SCANCODE_M) {
+					mMusic.Next();
+				}
+				if (event.scancode == SDL_SCANCODE_F2) {
+					mProfilerOverlay.Toggle();
+				}
+				if (event.scancode == SDL_SCANCODE_F3) {
+					mLayers.LogStats(); // Draw calls per render layer
+				}
+				if (event.scancode == SDL_SCANCODE_F4) {
+					// Start a trace capture, or cut the running one short
+					if (Profiler::Get().IsCapturing()) {
+						Profiler::Get().StopCapture();
+					}
+					else {
+						Profiler::Get().StartCapture(traceHotkeyPath, traceHotkeyFrames);
+					}
+				}
+			}
+			break;
+		}
+	}
+
+	// If escape is pressed, also end loop
+	if (mInputFrame.IsKeyDown(SDL_SCANCODE_ESCAPE))
+	{
+		mIsRunning = false;
+	}
+
+	// Next track when the current one ends
+	mMusic.Update();
+
+	// Textures and sounds that finished loading
+	mAssets.Update();
+	mAudio.SetSound(mJumpSound, mAssets.GetSound(mJumpAsset));
+	if (mAssetsLoadedTime < 0.0 && mAssets.GetPendingCount() == 0) {
+		mAssetsLoadedTime = (SDL_GetPerformanceCounter() - mStartupStart) * 1000.0 / SDL_GetPerformanceFrequency();
+	}
+}
+
+void Game::ApplyInput(const InputFrame& input)
+{
+	PROFILE_ZONE("Apply Input");
+
+	for (const InputEvent& event : input.events) {
+		switch (event.type) {
+		case SDL_KEYDOWN:
+			if (!event.repeat) {
+				if (event.scancode == SDL_SCANCODE_EQUALS) {
 			#ifndef NDEBUG
 					mGridSize += 10; // Increase grid size
 					mGridSize = std::min(mGridSize, 200); // Optional: Max grid size limit
 			#endif
 				}
-				if (event.key.keysym.scancode == SDL_SCANCODE_MINUS) {
+				if (event.scancode == SDL_SCANCODE_MINUS) {
 			#ifndef NDEBUG
 					mGridSize = std::max(10, mGridSize - 10); // Decrease grid size, minimum 10
 			#endif
@@ -239,8 +645,8 @@ void Game::ProcessInput()
 
 				// Handle inventory selection with number keys
 				// (I know I am big brained lmao uwu. I just came out with an idea at 2am LOL)
-				if (event.key.keysym.sym >= SDLK_1 && event.key.keysym.sym <= SDLK_9) {
-					int selectedBlock = event.key.keysym.sym - SDLK_1;
+				if (event.sym >= SDLK_1 && event.sym <= SDLK_9) {
+					int selectedBlock = event.sym - SDLK_1;
 					if (selectedBlock < mInventory.blocks.size()) {
 						mInventory.selectedIndex = selectedBlock;
 					}
@@ -251,51 +657,38 @@ void Game::ProcessInput()
 		}
 
 		if (event.type == SDL_MOUSEBUTTONDOWN) {
-			int x, y;
-			SDL_GetMouseState(&x, &y);
-			int gridX = x / mGridSize; // Calculate gridX based on mouse x-coordinate
-			int gridY = y / mGridSize; // Calculate gridY based on mouse y-coordinate
-
-			if (gridX < gridWidth && gridY < gridHeight) {
-				if (event.button.button == SDL_BUTTON_LEFT) {
-					gridBlocks[gridX][gridY].isActive = false; // Remove block
-				}
-				else if (event.button.button == SDL_BUTTON_RIGHT) {
-					if (mInventory.selectedIndex < mInventory.blocks.size()) {
-						gridBlocks[gridX][gridY] = mInventory.blocks[mInventory.selectedIndex]; // Place selected block
-						gridBlocks[gridX][gridY].isActive = true;
-					}
+			SDL_Point mouseWorld = mSimCamera.ScreenToWorld(input.mouseX, input.mouseY); // Mouse position in the world
+			int gridX = FloorDiv(mouseWorld.x, mGridSize); // Calculate gridX based on mouse x-coordinate
+			int gridY = FloorDiv(mouseWorld.y, mGridSize); // Calculate gridY based on mouse y-coordinate
+
+			if (event.button == SDL_BUTTON_LEFT) {
+				SetBlock(gridX, gridY, emptyBlock); // Remove block
+			}
+			else if (event.button == SDL_BUTTON_RIGHT) {
+				if (mInventory.selectedIndex < mInventory.blocks.size()) {
+					SetBlock(gridX, gridY, mInventory.blocks[mInventory.selectedIndex]); // Place selected block
 				}
 			}
 		}
 
 	}
 
-	// Handle block pickup
-	for (auto& pickup : mBlockPickups) {
-		if (pickup.isActive) {
-			SDL_Rect pickupRect = { static_cast<int>(pickup.position.x), static_cast<int>(pickup.position.y), mGridSize / 2, mGridSize / 2 };
-			if (CheckCollision(playerRect, pickupRect)) {
-				if (mInventory.blocks.size() < mInventory.maxCapacity) {
-					mInventory.blocks.push_back(pickup.block);
-					pickup.isActive = false; // Deactivate the pickup
-				}
-			}
+	// Handle block pickup (collected pickups are destroyed, as many as the inventory has room for)
+	{
+		PROFILE_ZONE("Pickups");
+		const int room = mInventory.maxCapacity - static_cast<int>(mInventory.blocks.size());
+		if (room > 0) {
+			CollectPickups(mPickups, mPickupCells, playerRect, mGridSize / 2, room, mInventory.blocks, mSimArena);
 		}
 	}
 	
 	// Get state of keyboard
-	const Uint8* state = SDL_GetKeyboardState(NULL);
-	// If escape is pressed, also end loop
-	if (state[SDL_SCANCODE_ESCAPE])
-	{
-		mIsRunning = false;
-	}
+	const InputFrame& state = input;
 
 
 
 	// Player movement logic
-	if (state[SDL_SCANCODE_A]) {
+	if (state.IsKeyDown(SDL_SCANCODE_A)) {
 		if (mPlayer.isCrouching) {
 			mPlayer.mVelX = -100.0f; // Move slower while crouching
 			mPlayer.facingRight = false; // Facing left
@@ -305,7 +698,7 @@ void Game::ProcessInput()
 			mPlayer.facingRight = false; // Facing left
 		}
 	}
-	else if (state[SDL_SCANCODE_D]) {
+	else if (state.IsKeyDown(SDL_SCANCODE_D)) {
 		if (mPlayer.isCrouching) {
 			mPlayer.mVelX = 100.0f; // Move slower while crouching
 			mPlayer.facingRight = true; // Facing right
@@ -318,16 +711,18 @@ void Game::ProcessInput()
 	else {
 		mPlayer.mVelX = 0.0f; // Stop moving horizontally
 	}
-	if (state[SDL_SCANCODE_W] && mPlayer.isOnGround) {
+	if (state.IsKeyDown(SDL_SCANCODE_W) && mPlayer.isOnGround) {
 		mPlayer.mVelY = -350.0f; // Set a negative velocity to move up
 		mPlayer.isOnGround = false;
-		Mix_PlayChannel(-1, mJump, 0); // Play Jump sound effect
+		PROFILE_ZONE("Audio");
+		mAudio.Play(mJumpSound); // Play Jump sound effect
 	}
-	if (state[SDL_SCANCODE_S]) {
+	if (state.IsKeyDown(SDL_SCANCODE_S)) {
 		if (!mPlayer.isCrouching) {
 			mPlayer.isCrouching = true;
 			mPlayer.mHeight = 60; // Crouch Height
 			mPlayer.mPos.y += 40; // Adjust position to stay on ground (100 - 60)
+			mPlayer.mPrevPos.y += 40; // Don't interpolate the snap
 		}
 	}
 	else {
@@ -335,33 +730,138 @@ void Game::ProcessInput()
 			mPlayer.isCrouching = false;
 			mPlayer.mHeight = 100; // Stand up
 			mPlayer.mPos.y -= 40; // Adjust position back to standing (100 - 60)
+			mPlayer.mPrevPos.y -= 40;
 		}
 	}
 	// Handle inventory selection
-	if (state[SDL_SCANCODE_LEFT]) {
+	if (state.IsKeyDown(SDL_SCANCODE_LEFT)) {
 		mInventory.selectedIndex = std::max(0, mInventory.selectedIndex - 1);
 	}
-	if (state[SDL_SCANCODE_RIGHT]) {
+	if (state.IsKeyDown(SDL_SCANCODE_RIGHT)) {
 		mInventory.selectedIndex = std::min(static_cast<int>(mInventory.blocks.size()) - 1, mInventory.selectedIndex + 1);
 	}
 }
 
 void Game::UpdateGame()
 {
-	// Wait until 16ms has elapsed since last frame	
-	while (!SDL_TICKS_PASSED(SDL_GetTicks(), mTicksCount + 16))
-		;
+	PROFILE_ZONE("Update");
 
-	// Delta time is the difference in ticks from last frame
-	// (converted to seconds)
-	float deltaTime = (SDL_GetTicks() - mTicksCount) / 1000.0f;
+	// Steps -> camera, highlight alongside (see BuildUpdateGraph)
+	mUpdateGraph.Run(mJobs);
+}
+
+void Game::BuildUpdateGraph()
+{
+	const int steps = mUpdateGraph.AddTask("Steps", [this] { StepSimulation(); });
+	mUpdateGraph.AddTask("Highlight", [this] { UpdateHighlight(); }); // Runs next to the steps
+	const int camera = mUpdateGraph.AddTask("Sim Camera", [this] {
+		// Same view GenerateOutput will show, for this frame's mouse picking
+		FollowPlayer(mSimCamera, mPlayer, mInterpolation);
+	});
+	mUpdateGraph.AddDependency(steps, camera);
+}
+
+void Game::StepSimulation()
+{
+	// Frame time is the time since the last frame (in seconds),
+	// taken from the input frame so replays step exactly like the recording
+	float frameTime = mSimInput.frameTime;
 	
-	// Clamp maximum delta time value
-	if (deltaTime > 0.05f)
+	// Clamp maximum frame time value
+	if (frameTime > maxFrameTime)
 	{
-		deltaTime = 0.05f;
+		frameTime = maxFrameTime;
+	}
+
+	// Run as many fixed simulation steps as the elapsed time covers,
+	// the remainder carries over to the next frame
+	mAccumulator += frameTime;
+	while (mAccumulator >= simTimeStep) {
+		Simulate(simTimeStep);
+		mAccumulator -= simTimeStep;
+	}
+
+	// How far we are between the last two simulation steps, for rendering
+	mInterpolation = mAccumulator / simTimeStep;
+}
+
+void Game::UpdateHighlight()
+{
+	// Update highlight color for selection (once per rendered frame)
+	const int colorChangeSpeed = 5; // Adjust speed of color change
+	if (highlightColorChangeDirection == 1) {
+		highlightColor.r = std::min(255, highlightColor.r + colorChangeSpeed);
+		highlightColor.g = std::min(255, highlightColor.g + colorChangeSpeed);
+		highlightColor.b = std::min(255, highlightColor.b + colorChangeSpeed);
+		if (highlightColor.r == 255 && highlightColor.g == 255 && highlightColor.b == 255) {
+			highlightColorChangeDirection = -1;
+		}
 	}
+	else {
+		highlightColor.r = std::max(0, highlightColor.r - colorChangeSpeed);
+		highlightColor.g = std::max(0, highlightColor.g - colorChangeSpeed);
+		highlightColor.b = std::max(0, highlightColor.b - colorChangeSpeed);
+		if (highlightColor.r == 0 && highlightColor.g == 0 && highlightColor.b == 0) {
+			highlightColorChangeDirection = 1;
+		}
+	}
+}
 
+void Game::PublishSnapshot()
+{
+	PROFILE_ZONE("Publish");
+
+	GameSnapshot& snapshot = snapshots.GetBack();
+	snapshot.player = mPlayer;
+
+	snapshot.sprites.clear();
+	for (int i = 0; i < mEntities.sprites.GetCount(); ++i) {
+		const Transform* transform = mEntities.transforms.Find(mEntities.sprites.GetEntity(i));
+		if (transform) {
+			const Sprite& sprite = mEntities.sprites.Get(i);
+			snapshot.sprites.push_back({ sprite.texture, transform->prevPosition, transform->position, sprite.width, sprite.height });
+		}
+	}
+
+	// Pickups the render camera could see, found through the hash so this
+	// doesn't grow with the number of pickups in the world
+	const int pickupSize = mGridSize / 2;
+	SDL_Rect view = mSimCamera.GetViewRect();
+	SDL_Rect pickupArea = { view.x - pickupSize, view.y - pickupSize, view.w + pickupSize, view.h + pickupSize };
+	FrameVector<PoolHandle> visiblePickups{ ArenaAllocator<PoolHandle>(mSimArena) };
+	mPickupCells.Query(pickupArea, visiblePickups);
+	snapshot.pickups.clear();
+	for (PoolHandle handle : visiblePickups) {
+		const Pickup* pickup = mPickups.Get(handle);
+		if (pickup) {
+			snapshot.pickups.push_back({ pickup->position, pickup->block });
+		}
+	}
+
+	snapshot.inventory = mInventory.blocks;
+	snapshot.selectedIndex = mInventory.selectedIndex;
+	snapshot.gridSize = mGridSize;
+	snapshot.interpolation = mInterpolation;
+	snapshot.highlightColor = highlightColor;
+
+	// Forget the block changes the render thread already applied, resend the rest
+	// (it may skip snapshots, so each one carries everything still outstanding)
+	const Uint32 rendered = renderedBlockChange.load(std::memory_order_acquire);
+	auto outstanding = std::find_if(pendingBlockChanges.begin(), pendingBlockChanges.end(),
+		[rendered](const BlockChange& change) { return change.sequence > rendered; });
+	pendingBlockChanges.erase(pendingBlockChanges.begin(), outstanding);
+	snapshot.blockChanges = pendingBlockChanges;
+
+	snapshots.Publish();
+}
+
+void Game::Simulate(float deltaTime)
+{
+	PROFILE_ZONE("Physics");
+
+	// Remember where things were for render interpolation
+	mPlayer.mPrevPos = mPlayer.mPos;
+	SavePreviousPositions(mEntities);
 
 	// Animation logic
 	const float frameDuration = 0.25f; // Duration of each frame in seconds
@@ -393,36 +893,41 @@ void Game::UpdateGame()
 		mPlayer.mHeight
 	};
 
-	for (int x = 0; x < gridWidth; ++x) {
-		for (int y = 0; y < gridHeight; ++y) {
-			if (gridBlocks[x][y].isActive) {
-				SDL_Rect blockRect = { x * mGridSize, y * mGridSize, mGridSize, mGridSize };
-				if (CheckCollision(playerRect, blockRect)) {
-					// Calculate overlap on each axis
-					float overlapX = std::min(playerRect.x + playerRect.w, blockRect.x + blockRect.w) - std::max(playerRect.x, blockRect.x);
-					float overlapY = std::min(playerRect.y + playerRect.h, blockRect.y + blockRect.h) - std::max(playerRect.y, blockRect.y);
-
-					// Resolve collision based on the axis of least overlap
-					if (overlapX < overlapY) {
-						// Horizontal collision
-						if (mPlayer.mVelX > 0) { // Moving right
-							mPlayer.mPos.x -= overlapX;
-						}
-						else if (mPlayer.mVelX < 0) { // Moving left
-							mPlayer.mPos.x += overlapX;
-						}
-						mPlayer.mVelX = 0;
-					}
-					else {
-						// Vertical collision
-						if (mPlayer.mVelY > 0) { // Falling down
-							mPlayer.mPos.y -= overlapY;
-							mPlayer.isOnGround = true;
+	// Only visit the cells under the player's hitbox (same x-then-y order as a full scan)
+	{
+		PROFILE_ZONE("Collision");
+		CellRange cells = GetOverlappingCells(playerRect, mGridSize);
+		for (int x = cells.minX; x <= cells.maxX; ++x) {
+			for (int y = cells.minY; y <= cells.maxY; ++y) {
+				if (mWorld.Get(x, y) != emptyBlock) {
+					SDL_Rect blockRect = { x * mGridSize, y * mGridSize, mGridSize, mGridSize };
+					if (CheckCollision(playerRect, blockRect)) {
+						// Calculate overlap on each axis
+						float overlapX = std::min(playerRect.x + playerRect.w, blockRect.x + blockRect.w) - std::max(playerRect.x, blockRect.x);
+						float overlapY = std::min(playerRect.y + playerRect.h, blockRect.y + blockRect.h) - std::max(playerRect.y, blockRect.y);
+
+						// Resolve collision based on the axis of least overlap
+						if (overlapX < overlapY) {
+							// Horizontal collision
+							if (mPlayer.mVelX > 0) { // Moving right
+								mPlayer.mPos.x -= overlapX;
+							}
+							else if (mPlayer.mVelX < 0) { // Moving left
+								mPlayer.mPos.x += overlapX;
+							}
+							mPlayer.mVelX = 0;
 						}
-						else if (mPlayer.mVelY < 0) { // Going up
-							mPlayer.mPos.y += overlapY;
+						else {
+							// Vertical collision
+							if (mPlayer.mVelY > 0) { // Falling down
+								mPlayer.mPos.y -= overlapY;
+								mPlayer.isOnGround = true;
+							}
+							else if (mPlayer.mVelY < 0) { // Going up
+								mPlayer.mPos.y += overlapY;
+							}
+							mPlayer.mVelY = 0;
 						}
-						mPlayer.mVelY = 0;
 					}
 				}
 			}
@@ -430,6 +935,8 @@ void Game::UpdateGame()
 	}
 
 	// Example of collision detection with ground
+	// (the ground is endless, only the part under the player matters)
+	groundRect = { playerRect.x, 768 - groundHeight, playerRect.w, groundHeight };
 	if (CheckCollision(playerRect, groundRect)) {
 		mPlayer.mPos.y = groundRect.y - mPlayer.mHeight;
 		mPlayer.isOnGround = true;
@@ -443,164 +950,182 @@ void Game::UpdateGame()
 		mPlayer.mVelY = 0.0f;
 	}
 
-	// Update highlight color for selection
-	const int colorChangeSpeed = 5; // Adjust speed of color change
-	if (highlightColorChangeDirection == 1) {
-		highlightColor.r = std::min(255, highlightColor.r + colorChangeSpeed);
-		highlightColor.g = std::min(255, highlightColor.g + colorChangeSpeed);
-		highlightColor.b = std::min(255, highlightColor.b + colorChangeSpeed);
-		if (highlightColor.r == 255 && highlightColor.g == 255 && highlightColor.b == 255) {
-			highlightColorChangeDirection = -1;
-		}
-	}
-	else {
-		highlightColor.r = std::max(0, highlightColor.r - colorChangeSpeed);
-		highlightColor.g = std::max(0, highlightColor.g - colorChangeSpeed);
-		highlightColor.b = std::max(0, highlightColor.b - colorChangeSpeed);
-		if (highlightColor.r == 0 && highlightColor.g == 0 && highlightColor.b == 0) {
-			highlightColorChangeDirection = 1;
-		}
-	}
-
-	// Update clouds
-	for (auto& cloud : clouds) {
-		cloud.position.x += cloud.speed * deltaTime;
-		if (cloud.position.x > 1024) { // If cloud moves off-screen
-			cloud.position.x = -static_cast<float>(cloud.width); // Reset to left side
-		}
-	}
-
-	// Update tick counts (for next frame)
-	mTicksCount = SDL_GetTicks();
+	// Move entities, clouds wrap around the view centered on the player
+	// (the camera itself follows the interpolated player in GenerateOutput)
+	PROFILE_ZONE("Movement");
+	const float viewLeft = mPlayer.mPos.x + mPlayer.mWidth / 2.0f - 1024 / 2.0f;
+	const float viewRight = viewLeft + 1024;
+	MoveEntities(mEntities, deltaTime, mJobs);
+	WrapEntities(mEntities, viewLeft, viewRight);
 }
 
 void Game::GenerateOutput() {
-    // Set background to blue
-    SDL_SetRenderDrawColor(mRenderer, 0, 191, 255, 255);
-    SDL_RenderClear(mRenderer);
-
-	// Draw clouds
-	for (const auto& cloud : clouds) {
-		// Define scale factor (e.g., 0.5 for half size)
-		float scaleFactor = 0.3f;
-
-		SDL_Rect cloudRect = {
-			static_cast<int>(cloud.position.x),
-			static_cast<int>(cloud.position.y),
-			static_cast<int>(cloud.width * scaleFactor),  // Scale width
-			static_cast<int>(cloud.height * scaleFactor)  // Scale height
-		};
-		SDL_RenderCopy(mRenderer, cloud.texture, NULL, &cloudRect);
+	// Draw the latest frame the simulation finished (the previous one again if
+	// it hasn't finished a new one yet)
+	snapshots.Acquire();
+	const GameSnapshot& snapshot = snapshots.GetFront();
+	const Player& player = snapshot.player;
+	const int gridSize = snapshot.gridSize;
+
+	// Catch the render world up with the simulation's
+	Uint32 rendered = renderedBlockChange.load(std::memory_order_relaxed);
+	for (const BlockChange& change : snapshot.blockChanges) {
+		if (change.sequence > rendered) {
+			mRenderWorld.Set(change.x, change.y, change.block);
+			rendered = change.sequence;
+		}
 	}
+	renderedBlockChange.store(rendered, std::memory_order_release);
 
-	// Draw ground
-	SDL_SetRenderDrawColor(mRenderer, 139, 69, 19, 255); // Brown color for ground
-	groundRect = { 0, 768 - groundHeight, 1024, groundHeight };
-	SDL_RenderFillRect(mRenderer, &groundRect);
+	// Draw everything between the last two simulation steps
+	Vector2 playerPos = Lerp(player.mPrevPos, player.mPos, snapshot.interpolation);
 
-	SDL_Rect srcRect = {
-		mPlayer.frameWidth * mPlayer.currentFrame, // X position based on current frame
-		0, // Y position (top of the sprite sheet)
-		mPlayer.frameWidth,
-		mPlayer.frameHeight
-	};
+	// Keep the camera centered on the player
+	FollowPlayer(mCamera, player, snapshot.interpolation);
 
-	int adjustedHeight = mPlayer.mHeight;
-	int yOffset = 0;
+	mLayers.BeginFrame();
 
-	// Adjust height and Y-offset if the player is crouching
-	if (mPlayer.isCrouching) {
-		adjustedHeight /= 2; // Example: Reduce height by half
-		yOffset = adjustedHeight; // Move down to keep feet at the same position
+	// Sky layer
+	mLayers.BeginLayer(LayerSky);
+    // Set background to blue
+    mLayers.SetDrawColor(0, 191, 255, 255);
+    mLayers.Clear();
+
+	// Cloud layer
+	mLayers.BeginLayer(LayerClouds);
+	for (const SpriteDraw& sprite : snapshot.sprites) {
+		Vector2 spritePos = Lerp(sprite.prevPosition, sprite.position, snapshot.interpolation);
+		SDL_Rect spriteRect = {
+			static_cast<int>(spritePos.x),
+			static_cast<int>(spritePos.y),
+			sprite.width,
+			sprite.height
+		};
+		if (!mCamera.IsVisible(spriteRect)) {
+			continue;
+		}
+		SDL_Texture* texture = mAssets.GetTexture(mSpriteTextures[sprite.texture]);
+		if (!texture) {
+			continue; // Still loading
+		}
+		spriteRect = mCamera.WorldToScreen(spriteRect);
+		mLayers.Copy(texture, NULL, &spriteRect);
 	}
 
-	SDL_RendererFlip flipType = mPlayer.facingRight ? SDL_FLIP_NONE : SDL_FLIP_HORIZONTAL;
-
-	SDL_Rect destRect = {
-		static_cast<int>(mPlayer.mPos.x),
-		static_cast<int>(mPlayer.mPos.y) + yOffset,
-		mPlayer.frameWidth,
-		adjustedHeight
-	};
-
-	SDL_RenderCopyEx(mRenderer, mPlayer.spriteSheet, &srcRect, &destRect, 0.0, NULL, flipType);
+	// World layer
+	mLayers.BeginLayer(LayerWorld);
 
+	// Draw ground
+	mLayers.SetDrawColor(139, 69, 19, 255); // Brown color for ground
+	SDL_Rect view = mCamera.GetViewRect();
+	SDL_Rect groundViewRect = { view.x, 768 - groundHeight, view.w, groundHeight }; // Ground runs under the whole view
+	mLayers.FillRect(mCamera.WorldToScreen(groundViewRect));
 
 	// Get current mouse position
-	int mouseX, mouseY;
-	SDL_GetMouseState(&mouseX, &mouseY);
+	int mouseX = mInputFrame.mouseX;
+	int mouseY = mInputFrame.mouseY;
 
 	// Set the range around the mouse to display the grid
 	int gridRange = 3; // This is the number of grid cells around the mouse to display
 
-	// Calculate the top-left corner for the grid rendering
-	int startX = mouseX - (mouseX % mGridSize) - (gridRange * mGridSize);
-	int startY = mouseY - (mouseY % mGridSize) - (gridRange * mGridSize);
+	// Calculate the top-left corner for the grid rendering (snapped to world cells)
+	SDL_Point mouseWorld = mCamera.ScreenToWorld(mouseX, mouseY);
+	SDL_Point gridStart = mCamera.WorldToScreen(
+		FloorDiv(mouseWorld.x, gridSize) * gridSize - (gridRange * gridSize),
+		FloorDiv(mouseWorld.y, gridSize) * gridSize - (gridRange * gridSize));
+	int startX = gridStart.x;
+	int startY = gridStart.y;
 
 	// Draw grid keybind
 	if (mShowGrid) {
-		SDL_SetRenderDrawColor(mRenderer, 255, 255, 255, 255); // White color for grid
+		mLayers.SetDrawColor(255, 255, 255, 255); // White color for grid
 
 		// Draw vertical lines within range
-		for (int x = startX; x <= startX + 2 * gridRange * mGridSize; x += mGridSize) {
-			SDL_RenderDrawLine(mRenderer, x, startY, x, startY + 2 * gridRange * mGridSize);
+		for (int x = startX; x <= startX + 2 * gridRange * gridSize; x += gridSize) {
+			mLayers.DrawLine(x, startY, x, startY + 2 * gridRange * gridSize);
 		}
 
 		// Draw horizontal lines within range
-		for (int y = startY; y <= startY + 2 * gridRange * mGridSize; y += mGridSize) {
-			SDL_RenderDrawLine(mRenderer, startX, y, startX + 2 * gridRange * mGridSize, y);
+		for (int y = startY; y <= startY + 2 * gridRange * gridSize; y += gridSize) {
+			mLayers.DrawLine(startX, y, startX + 2 * gridRange * gridSize, y);
 		}
 	}
 
 	// Draw blocks
-	for (int x = 0; x < gridWidth; ++x) {
-		for (int y = 0; y < gridHeight; ++y) {
-			if (gridBlocks[x][y].isActive) {
-				SDL_Rect blockRect = { x * mGridSize, y * mGridSize, mGridSize, mGridSize };
-				SDL_SetRenderDrawColor(mRenderer, gridBlocks[x][y].color.r, gridBlocks[x][y].color.g, gridBlocks[x][y].color.b, gridBlocks[x][y].color.a);
-				SDL_RenderFillRect(mRenderer, &blockRect);
-			}
+	DrawBlocks(gridSize);
+
+	// Entity layer
+	mLayers.BeginLayer(LayerEntities);
+
+	// Draw block pickups
+	for (const PickupDraw& pickup : snapshot.pickups) {
+		SDL_Rect pickupRect = { static_cast<int>(pickup.position.x), static_cast<int>(pickup.position.y), gridSize / 2, gridSize / 2 };
+		if (!mCamera.IsVisible(pickupRect)) {
+			continue;
 		}
+		mBatcher.Add(pickup.block, mCamera.WorldToScreen(pickupRect));
 	}
+	mBatcher.Flush(mLayers);
+
+	// Player layer
+	mLayers.BeginLayer(LayerPlayer);
+
+	SDL_Rect srcRect = {
+		player.frameWidth * player.currentFrame, // X position based on current frame
+		0, // Y position (top of the sprite sheet)
+		player.frameWidth,
+		player.frameHeight
+	};
+
+	int adjustedHeight = player.mHeight;
+	int yOffset = 0;
 
-	// Draw inventory grid
-	for (size_t i = 0; i < mInventory.blocks.size(); ++i) {
-		SDL_Rect invRect = { static_cast<int>(i * mGridSize), 768 - mGridSize, mGridSize, mGridSize };
-		SDL_SetRenderDrawColor(mRenderer, mInventory.blocks[i].color.r, mInventory.blocks[i].color.g, mInventory.blocks[i].color.b, mInventory.blocks[i].color.a);
-		SDL_RenderFillRect(mRenderer, &invRect);
+	// Adjust height and Y-offset if the player is crouching
+	if (player.isCrouching) {
+		adjustedHeight /= 2; // Example: Reduce height by half
+		yOffset = adjustedHeight; // Move down to keep feet at the same position
 	}
 
-	// Draw block pickups
-	for (const auto& pickup : mBlockPickups) {
-		if (pickup.isActive) {
-			SDL_Rect pickupRect = { static_cast<int>(pickup.position.x), static_cast<int>(pickup.position.y), mGridSize / 2, mGridSize / 2 };
-			SDL_SetRenderDrawColor(mRenderer, pickup.block.color.r, pickup.block.color.g, pickup.block.color.b, pickup.block.color.a);
-			SDL_RenderFillRect(mRenderer, &pickupRect);
-		}
+	SDL_RendererFlip flipType = player.facingRight ? SDL_FLIP_NONE : SDL_FLIP_HORIZONTAL;
+
+	SDL_Rect destRect = {
+		static_cast<int>(playerPos.x),
+		static_cast<int>(playerPos.y) + yOffset,
+		player.frameWidth,
+		adjustedHeight
+	};
+	destRect = mCamera.WorldToScreen(destRect);
+
+	SDL_Texture* spriteSheet = mAssets.GetTexture(mPlayerSprite);
+	if (spriteSheet) {
+		mLayers.CopyEx(spriteSheet, &srcRect, &destRect, flipType);
 	}
 
+	// HUD layer (screen space)
+	mLayers.BeginLayer(LayerHUD);
+
 	// Draw inventory grid background
-	SDL_SetRenderDrawColor(mRenderer, 50, 50, 50, 255); // Dark gray color for inventory background
+	mLayers.SetDrawColor(50, 50, 50, 255); // Dark gray color for inventory background
 	SDL_Rect invBackgroundRect = { 0, invGridYPos, 1024, invGridSize };
-	SDL_RenderFillRect(mRenderer, &invBackgroundRect);
+	mLayers.FillRect(invBackgroundRect);
 
 	// Calculate starting position for inventory blocks
-	int invStartX = 512 - (mInventory.blocks.size() * invGridSize) / 2;
+	int invStartX = 512 - (snapshot.inventory.size() * invGridSize) / 2;
 
 	// Draw inventory blocks
-	for (size_t i = 0; i < mInventory.blocks.size(); ++i) {
+	for (size_t i = 0; i < snapshot.inventory.size(); ++i) {
 		SDL_Rect invBlockRect = { invStartX + static_cast<int>(i * invGridSize), invGridYPos, invGridSize, invGridSize };
-		SDL_SetRenderDrawColor(mRenderer, mInventory.blocks[i].color.r, mInventory.blocks[i].color.g, mInventory.blocks[i].color.b, mInventory.blocks[i].color.a);
-		SDL_RenderFillRect(mRenderer, &invBlockRect);
+		mBatcher.Add(snapshot.inventory[i], invBlockRect);
 	}
+	mBatcher.Flush(mLayers);
 
 	// Highlight selected block in inventory
 	
-	int selectedX = invStartX + mInventory.selectedIndex * invGridSize;
+	int selectedX = invStartX + snapshot.selectedIndex * invGridSize;
 	SDL_Rect selectedRect = { selectedX, invGridYPos, invGridSize, invGridSize };
 
 	// Set the color for the highlight
-	SDL_SetRenderDrawColor(mRenderer, highlightColor.r, highlightColor.g, highlightColor.b, highlightColor.a);
+	mLayers.SetDrawColor(snapshot.highlightColor);
 
 	// Draw multiple rectangles for a thicker border
 	for (int i = 0; i < highlightThickness; ++i) {
@@ -608,29 +1133,99 @@ void Game::GenerateOutput() {
 			selectedRect.x - i, selectedRect.y - i,
 			selectedRect.w + 2 * i, selectedRect.h + 2 * i
 		};
-		SDL_RenderDrawRect(mRenderer, &highlightRect);
+		mLayers.DrawRect(highlightRect);
+	}
+
+	// Profiler graph on top of everything
+	if (mProfilerOverlay.IsVisible()) {
+		mProfilerOverlay.SetStatusLine(0, "Draw calls     " + std::to_string(mLayers.GetTotalDrawCalls()));
+		mProfilerOverlay.SetStatusLine(1, "Chunks         " + std::to_string(mRenderWorld.GetChunkCount()));
+		mProfilerOverlay.SetStatusLine(2, "Frame arena    " + FormatArenaUsage(mFrameArena));
+		mProfilerOverlay.SetStatusLine(3, "Sim arena      " + FormatArenaUsage(mSimArena));
+		mProfilerOverlay.Draw(mLayers);
 	}
 
-	SDL_SetRenderDrawColor(mRenderer, highlightColor.r, highlightColor.g, highlightColor.b, highlightColor.a);
-	SDL_RenderDrawRect(mRenderer, &selectedRect);
+	mLayers.EndFrame();
+
+	PROFILE_ZONE("Present");
+    SDL_RenderPresent(mRenderer);
+}
+
+void Game::DrawBlocks(int gridSize)
+{
+	// Only visit the chunks that are on screen
+	CellRange cells = GetOverlappingCells(mCamera.GetViewRect(), gridSize);
+	const int minChunkX = FloorDiv(cells.minX, chunkSize);
+	const int minChunkY = FloorDiv(cells.minY, chunkSize);
+	const int maxChunkX = FloorDiv(cells.maxX, chunkSize);
+	const int maxChunkY = FloorDiv(cells.maxY, chunkSize);
+
+	FrameVector<const Chunk*> uncachedChunks{ ArenaAllocator<const Chunk*>(mFrameArena) }; // Drawn block by block
+	for (int chunkY = minChunkY; chunkY <= maxChunkY; ++chunkY) {
+		for (int chunkX = minChunkX; chunkX <= maxChunkX; ++chunkX) {
+			const Chunk* chunk = mRenderWorld.FindChunk(chunkX, chunkY);
+			if (!chunk) {
+				continue;
+			}
 
-	for (int x = 0; x < gridWidth; ++x) {
-		for (int y = 0; y < gridHeight; ++y) {
-			if (gridBlocks[x][y].isActive) {
-				SDL_Rect blockRect = { x * mGridSize, y * mGridSize, mGridSize, mGridSize };
-				SDL_SetRenderDrawColor(mRenderer, gridBlocks[x][y].color.r, gridBlocks[x][y].color.g, gridBlocks[x][y].color.b, gridBlocks[x][y].color.a);
-				SDL_RenderFillRect(mRenderer, &blockRect);
+			// Cached texture, only redrawn when a block in the chunk changed
+			if (mUseChunkCache) {
+				SDL_Texture* texture = mChunkCache.GetTexture(*chunk, mLayers, mBatcher);
+				if (texture) {
+					const int chunkPixels = chunkSize * gridSize;
+					SDL_Rect chunkRect = { chunkX * chunkPixels, chunkY * chunkPixels, chunkPixels, chunkPixels };
+					SDL_Rect screenRect = mCamera.WorldToScreen(chunkRect);
+					mLayers.Copy(texture, NULL, &screenRect);
+					continue;
+				}
 			}
+			uncachedChunks.push_back(chunk);
 		}
 	}
 
+	// No render target, batch the visible cells by color instead. Each job
+	// batches a range of chunks into its own batcher, merged for one draw per color.
+	const int chunkCount = static_cast<int>(uncachedChunks.size());
+	const int batchSize = mJobs.GetBatchSize(chunkCount, 2);
+	const int batchCount = (chunkCount + batchSize - 1) / batchSize;
+	if (static_cast<int>(mChunkBatchers.size()) < batchCount) {
+		mChunkBatchers.resize(batchCount);
+	}
 
-    SDL_RenderPresent(mRenderer);
+	const int viewX = mCamera.GetX();
+	const int viewY = mCamera.GetY();
+	mJobs.ParallelFor(chunkCount, batchSize, [&](int begin, int end) {
+		PROFILE_ZONE("Batch Chunks");
+		BlockBatcher& batcher = mChunkBatchers[begin / batchSize];
+		for (int i = begin; i < end; ++i) {
+			batcher.AddChunk(*uncachedChunks[i], cells, gridSize, viewX, viewY);
+		}
+	});
+	for (int i = 0; i < batchCount; ++i) {
+		mBatcher.Merge(mChunkBatchers[i]);
+	}
+
+	mBatcher.Flush(mLayers);
+	mChunkCache.EndFrame();
 }
 
 void Game::Shutdown()
 {
-	SDL_DestroyTexture(mPlayer.spriteSheet);
+	StopSimulation(); // In case RunLoop never ran
+	mJobs.Shutdown();
+	mAudio.Shutdown(); // Stops playing the chunks before they're freed
+	mMusic.Shutdown();
+	Profiler::Get().StopCapture(); // Write out a capture still running
+	mChunkCache.Clear();
+	mProfilerOverlay.Shutdown();
+	mAssets.Release(mJumpAsset);
+	mAssets.Release(mPlayerSprite);
+	for (AssetHandle texture : mSpriteTextures) {
+		mAssets.Release(texture);
+	}
+	mSpriteTextures.clear();
+	mAssets.Shutdown();
+	mArchive.Close(); // After everything playing or drawing from the mapping
 	SDL_DestroyRenderer(mRenderer);
 	SDL_DestroyWindow(mWindow);
 	SDL_Quit();
@@ -1,41 +1,135 @@
 #pragma once
 #include "SDL/SDL.h"
 #include "SDL/SDL_image.h"
+#include "AssetManager.h"
+#include "AudioService.h"
+#include "Benchmark.h"
+#include "BlockBatcher.h"
+#include "ChunkRenderCache.h"
+#include "FrameArena.h"
+#include "FrameScheduler.h"
+#include "Input.h"
+#include "MusicPlayer.h"
+#include "JobSystem.h"
+#include "Profiler.h"
+#include "ProfilerOverlay.h"
+#include "RenderLayers.h"
+#include "SpscQueue.h"
+#include "Vector2.h"
 
 #include <SDL/SDL_mixer.h>
 #include <SDL/SDL_audio.h>
 
 #include <algorithm>
+#include <atomic>
 #include <vector>
 
-struct Vector2
-{
-	float x;
-	float y;
-};
-
 class Game
 {
 public:
 	Game();
 	bool Initialize();
+	void SetTargetFrameRate(int framesPerSecond); // 0 for uncapped
+
+	// Run without a real window or audio device (dummy video/audio drivers,
+	// software renderer, no frame cap) for a fixed number of frames, then
+	// print per-phase timings. Call before Initialize.
+	void SetHeadless(int frameCount);
+
+	// Random seed for everything generated at startup (clouds)
+	void SetSeed(Uint32 seed);
+
+	// Scatter count block pickups over the map at startup, to stress test
+	// pickup collection (a replay needs the same count). Call before Initialize.
+	void SetPickupCount(int count);
+
+	// Record this run's input (and seed) to a file, or play one back.
+	// Call before Initialize; a replay overrides the seed with the recorded one.
+	bool StartRecording(const char* path);
+	bool StartReplay(const char* path);
+
+	// Capture a trace of the first frameCount frames (see Profiler)
+	void StartTrace(const char* path, int frameCount);
 	void RunLoop();
 	void Shutdown();
 private:
+	// Main thread: polls input, handles window and debug keys, draws
 	void ProcessInput();
-	void UpdateGame();
 	void GenerateOutput();
+	void DrawBlocks(int gridSize);
+
+	// Simulation thread: gameplay input, fixed steps, snapshot for GenerateOutput
+	bool StartSimulation();
+	void StopSimulation(); // Simulates the frames still queued first
+	static int SDLCALL SimulationThread(void* game);
+	void RunSimulation();
+	void ApplyInput(const InputFrame& input);
+	void UpdateGame();
+	void BuildUpdateGraph();
+	void StepSimulation();
+	void UpdateHighlight();
+	void Simulate(float deltaTime);
+	void PublishSnapshot();
 
 	bool mIsRunning;
 	SDL_Window* mWindow;
 	SDL_Renderer* mRenderer;
-	Uint32 mTicksCount;
+	RenderLayers mLayers;
+	BlockBatcher mBatcher;
+	ChunkRenderCache mChunkCache;
+	std::vector<BlockBatcher> mChunkBatchers;  // One per job batch of the chunks drawn block by block
+	std::vector<AssetHandle> mSpriteTextures; // Sprite::texture indexes this
+	bool mUseChunkCache;
+	FrameScheduler mScheduler;
+	float mFrameTime; // Real time since the last frame, before input substitutes a replayed one
+	InputSource mInput;
+	InputFrame mInputFrame;
+	Uint32 mSeed;
+	int mPickupCount;
+	float mAccumulator;   // Simulation time not yet stepped (seconds)
+	float mInterpolation; // 0..1 between the previous and current simulation step
+
+	// Simulation thread
+	SDL_Thread* mSimThread;
+	SDL_sem* mSimWake; // Posted once per queued input frame, and to quit
+	std::atomic<bool> mSimQuit;
+	SpscQueue<InputFrame, 16> mSimInputQueue;
+	InputFrame mSimInput; // Frame being simulated
+
+	// Per-frame temporaries, one arena per thread. Reset at the top of
+	// every RunLoop and RunSimulation frame.
+	FrameArena mFrameArena; // Main thread
+	FrameArena mSimArena;   // Simulation thread
+
+	// Worker threads for loops inside a frame
+	JobSystem mJobs;
+	TaskGraph mUpdateGraph;
+
+	// Headless benchmark run
+	bool mHeadless;
+	int mHeadlessFrames;
+	Uint64 mStartupStart; // Performance counter when Initialize started
+	double mStartupTime; // Milliseconds spent in Initialize
+	double mAssetsLoadedTime; // Milliseconds from Initialize until the first loads finished, -1 until then
+	size_t mStartupResident; // Peak resident bytes at the end of Initialize
+	PhaseStats mInputStats;
+	PhaseStats mUpdateStats;
+	PhaseStats mOutputStats;
+
+	ProfilerOverlay mProfilerOverlay; // F2
 
 	SDL_Color highlightColor;
 	int highlightColorChangeDirection;
 	int highlightThickness;
 
+	// Textures and sounds, loaded in the background
+	AssetArchive mArchive; // Assets.pak, when the build packed one
+	AssetManager mAssets;
+	AssetHandle mPlayerSprite;
+	AssetHandle mJumpAsset;
+
 	// Sounds
-	Mix_Chunk* mSoundtrack;
-	Mix_Chunk* mJump;
+	MusicPlayer mMusic; // M skips to the next track
+	AudioService mAudio; // Sound effects, requested from the simulation thread
+	SoundId mJumpSound;
 };
@@ -0,0 +1,254 @@
+#include "Input.h"
+
+#include <cstring>
+
+// Recording file: header, then one record per frame
+//   header: "PGIR", Uint32 version, Uint32 seed
+//   frame:  Uint8 flags, Uint32 frameTime (float bits),
+//           [keys] if flags & keysChanged, [mouse x, y, buttons] if flags & mouseChanged,
+//           Uint16 event count, events
+// Everything is little endian.
+const char recordingMagic[4] = { 'P', 'G', 'I', 'R' };
+const Uint32 recordingVersion = 1;
+const Uint8 keysChanged = 1 << 0;
+const Uint8 mouseChanged = 1 << 1;
+
+static Uint32 FloatBits(float value)
+{
+	Uint32 bits;
+	memcpy(&bits, &value, sizeof(bits));
+	return bits;
+}
+
+static float BitsToFloat(Uint32 bits)
+{
+	float value;
+	memcpy(&value, &bits, sizeof(value));
+	return value;
+}
+
+InputSource::InputSource()
+{
+	mRecord = nullptr;
+	mReplay = nullptr;
+	mFrameCount = 0;
+	mReplayFinished = false;
+	mQuitRequested = false;
+	mRenderTargetsReset = false;
+	memset(mPrevious.keys, 0, sizeof(mPrevious.keys));
+	mPrevious.frameTime = 0.0f;
+	mPrevious.mouseX = 0;
+	mPrevious.mouseY = 0;
+	mPrevious.mouseButtons = 0;
+}
+
+InputSource::~InputSource()
+{
+	Close();
+}
+
+bool InputSource::StartRecording(const char* path, Uint32 seed)
+{
+	Close();
+	mRecord = SDL_RWFromFile(path, "wb");
+	if (!mRecord) {
+		SDL_Log("Failed to open input recording %s: %s", path, SDL_GetError());
+		return false;
+	}
+
+	SDL_RWwrite(mRecord, recordingMagic, 1, sizeof(recordingMagic));
+	SDL_WriteLE32(mRecord, recordingVersion);
+	SDL_WriteLE32(mRecord, seed);
+	return true;
+}
+
+bool InputSource::StartReplay(const char* path, Uint32& seed)
+{
+	Close();
+	mReplay = SDL_RWFromFile(path, "rb");
+	if (!mReplay) {
+		SDL_Log("Failed to open input recording %s: %s", path, SDL_GetError());
+		return false;
+	}
+
+	char magic[4];
+	if (SDL_RWread(mReplay, magic, 1, sizeof(magic)) != sizeof(magic) ||
+		memcmp(magic, recordingMagic, sizeof(magic)) != 0 ||
+		SDL_ReadLE32(mReplay) != recordingVersion) {
+		SDL_Log("%s is not an input recording this build can play", path);
+		Close();
+		return false;
+	}
+
+	seed = SDL_ReadLE32(mReplay);
+	return true;
+}
+
+bool InputSource::Poll(InputFrame& frame, float frameTime)
+{
+	mQuitRequested = false;
+	mRenderTargetsReset = false;
+
+	if (mReplay) {
+		if (!ReadFrame(frame)) {
+			mReplayFinished = true;
+			return false;
+		}
+	}
+	else {
+		PollSDL(frame, frameTime);
+		if (mRecord) {
+			WriteFrame(frame);
+		}
+	}
+
+	++mFrameCount;
+	return true;
+}
+
+void InputSource::PollSDL(InputFrame& frame, float frameTime)
+{
+	frame.frameTime = frameTime;
+	frame.events.clear();
+
+	SDL_Event event;
+	while (SDL_PollEvent(&event)) {
+		if (HandleWindowEvent(event)) {
+			continue; // Not recorded
+		}
+
+		InputEvent input = { event.type, 0, 0, 0, 0 };
+		switch (event.type) {
+		case SDL_KEYDOWN:
+			input.scancode = static_cast<Uint16>(event.key.keysym.scancode);
+			input.sym = event.key.keysym.sym;
+			input.repeat = event.key.repeat;
+			break;
+		case SDL_MOUSEBUTTONDOWN:
+			input.button = event.button.button;
+			break;
+		default:
+			continue; // Nothing in the game reads anything else
+		}
+		frame.events.push_back(input);
+	}
+
+	int numKeys = 0;
+	const Uint8* state = SDL_GetKeyboardState(&numKeys);
+	memset(frame.keys, 0, sizeof(frame.keys));
+	for (int i = 0; i < numKeys && i < SDL_NUM_SCANCODES; ++i) {
+		if (state[i]) {
+			frame.keys[i / 8] |= 1 << (i % 8);
+		}
+	}
+
+	frame.mouseButtons = SDL_GetMouseState(&frame.mouseX, &frame.mouseY);
+}
+
+bool InputSource::HandleWindowEvent(const SDL_Event& event)
+{
+	switch (event.type) {
+	case SDL_QUIT:
+		mQuitRequested = true;
+		return true;
+	case SDL_RENDER_TARGETS_RESET:
+		mRenderTargetsReset = true;
+		return true;
+	default:
+		return false;
+	}
+}
+
+void InputSource::WriteFrame(const InputFrame& frame)
+{
+	Uint8 flags = 0;
+	if (memcmp(frame.keys, mPrevious.keys, sizeof(frame.keys)) != 0) {
+		flags |= keysChanged;
+	}
+	if (frame.mouseX != mPrevious.mouseX || frame.mouseY != mPrevious.mouseY || frame.mouseButtons != mPrevious.mouseButtons) {
+		flags |= mouseChanged;
+	}
+
+	SDL_WriteU8(mRecord, flags);
+	SDL_WriteLE32(mRecord, FloatBits(frame.frameTime));
+	if (flags & keysChanged) {
+		SDL_RWwrite(mRecord, frame.keys, 1, sizeof(frame.keys));
+		memcpy(mPrevious.keys, frame.keys, sizeof(frame.keys));
+	}
+	if (flags & mouseChanged) {
+		SDL_WriteLE32(mRecord, static_cast<Uint32>(frame.mouseX));
+		SDL_WriteLE32(mRecord, static_cast<Uint32>(frame.mouseY));
+		SDL_WriteLE32(mRecord, frame.mouseButtons);
+		mPrevious.mouseX = frame.mouseX;
+		mPrevious.mouseY = frame.mouseY;
+		mPrevious.mouseButtons = frame.mouseButtons;
+	}
+
+	SDL_WriteLE16(mRecord, static_cast<Uint16>(frame.events.size()));
+	for (const InputEvent& event : frame.events) {
+		SDL_WriteLE32(mRecord, event.type);
+		SDL_WriteLE16(mRecord, event.scancode);
+		SDL_WriteLE32(mRecord, static_cast<Uint32>(event.sym));
+		SDL_WriteU8(mRecord, event.repeat);
+		SDL_WriteU8(mRecord, event.button);
+	}
+}
+
+bool InputSource::ReadFrame(InputFrame& frame)
+{
+	Uint8 flags = 0;
+	if (SDL_RWread(mReplay, &flags, 1, 1) != 1) {
+		return false; // End of the recording
+	}
+
+	frame.frameTime = BitsToFloat(SDL_ReadLE32(mReplay));
+	if (flags & keysChanged) {
+		if (SDL_RWread(mReplay, mPrevious.keys, 1, sizeof(mPrevious.keys)) != sizeof(mPrevious.keys)) {
+			return false;
+		}
+	}
+	if (flags & mouseChanged) {
+		mPrevious.mouseX = static_cast<Sint32>(SDL_ReadLE32(mReplay));
+		mPrevious.mouseY = static_cast<Sint32>(SDL_ReadLE32(mReplay));
+		mPrevious.mouseButtons = SDL_ReadLE32(mReplay);
+	}
+	memcpy(frame.keys, mPrevious.keys, sizeof(frame.keys));
+	frame.mouseX = mPrevious.mouseX;
+	frame.mouseY = mPrevious.mouseY;
+	frame.mouseButtons = mPrevious.mouseButtons;
+
+	const Uint16 eventCount = SDL_ReadLE16(mReplay);
+	frame.events.clear();
+	for (Uint16 i = 0; i < eventCount; ++i) {
+		InputEvent event;
+		event.type = SDL_ReadLE32(mReplay);
+		event.scancode = SDL_ReadLE16(mReplay);
+		event.sym = static_cast<Sint32>(SDL_ReadLE32(mReplay));
+		event.repeat = SDL_ReadU8(mReplay);
+		event.button = SDL_ReadU8(mReplay);
+		if (event.type != SDL_QUIT && event.type != SDL_RENDER_TARGETS_RESET) {
+			frame.events.push_back(event); // Older recordings stored window events too
+		}
+	}
+
+	// Keep the window responsive (and closable) while replaying. Window
+	// events are live, the replayed frame stays as recorded.
+	SDL_Event event;
+	while (SDL_PollEvent(&event)) {
+		HandleWindowEvent(event);
+	}
+
+	return true;
+}
+
+void InputSource::Close()
+{
+	if (mRecord) {
+		SDL_RWclose(mRecord);
+		mRecord = nullptr;
+	}
+	if (mReplay) {
+		SDL_RWclose(mReplay);
+		mReplay = nullptr;
+	}
+}
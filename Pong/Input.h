@@ -0,0 +1,79 @@
+#pragma once
+#include "SDL/SDL.h"
+
+#include <vector>
+
+// One SDL event, reduced to the fields the game reads
+struct InputEvent
+{
+	Uint32 type;       // SDL_KEYDOWN, SDL_MOUSEBUTTONDOWN
+	Uint16 scancode;   // Key events
+	Sint32 sym;        // Key events
+	Uint8 repeat;      // Key events
+	Uint8 button;      // Mouse button events
+};
+
+// Everything ProcessInput and GenerateOutput read for one frame
+struct InputFrame
+{
+	float frameTime; // Seconds since the previous frame
+	Uint8 keys[SDL_NUM_SCANCODES / 8]; // Keyboard state, one bit per scancode
+	int mouseX;
+	int mouseY;
+	Uint32 mouseButtons;
+	std::vector<InputEvent> events;
+
+	bool IsKeyDown(SDL_Scancode scancode) const
+	{
+		return (keys[scancode / 8] & (1 << (scancode % 8))) != 0;
+	}
+};
+
+// Where each frame's input comes from: SDL (optionally recorded to a file)
+// or a recording being played back. Recordings also store the frame time
+// and the random seed, so a replay steps the simulation exactly like the
+// original run did. Window events (quit, lost render targets) belong to
+// this run, not the recorded one: they're never recorded and always come
+// live from SDL, replaying or not.
+class InputSource
+{
+public:
+	InputSource();
+	~InputSource();
+
+	// Record every polled frame to a file
+	bool StartRecording(const char* path, Uint32 seed);
+
+	// Play frames back from a recording instead of polling SDL
+	// (seed receives the seed the recording was made with)
+	bool StartReplay(const char* path, Uint32& seed);
+
+	bool IsReplaying() const { return mReplay != nullptr; }
+	bool IsReplayFinished() const { return mReplayFinished; }
+	int GetFrameCount() const { return mFrameCount; }
+
+	// Fill in this frame's input. frameTime is the real time since the last
+	// frame, a replay substitutes the recorded one. Returns false once a
+	// replay runs out of frames.
+	bool Poll(InputFrame& frame, float frameTime);
+
+	// Live window events seen by the last Poll
+	bool IsQuitRequested() const { return mQuitRequested; }
+	bool WereRenderTargetsReset() const { return mRenderTargetsReset; }
+
+	void Close();
+
+private:
+	void PollSDL(InputFrame& frame, float frameTime);
+	bool HandleWindowEvent(const SDL_Event& event); // True if it was one
+	void WriteFrame(const InputFrame& frame);
+	bool ReadFrame(InputFrame& frame);
+
+	SDL_RWops* mRecord;
+	SDL_RWops* mReplay;
+	InputFrame mPrevious; // Last frame written/read (keys and mouse are delta coded)
+	int mFrameCount;
+	bool mReplayFinished;
+	bool mQuitRequested;
+	bool mRenderTargetsReset;
+};
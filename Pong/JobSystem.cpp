@@ -0,0 +1,253 @@
+#include "JobSystem.h"
+#include "Profiler.h"
+
+#include <algorithm>
+#include <thread>
+
+namespace
+{
+	thread_local int currentWorker = -1; // Index of the worker running on this thread
+}
+
+JobSystem::JobSystem()
+	: mWake(nullptr)
+	, mQuit(false)
+	, mNextQueue(0)
+{
+}
+
+JobSystem::~JobSystem()
+{
+	Shutdown();
+}
+
+bool JobSystem::Initialize(int workerCount)
+{
+	Shutdown();
+
+	if (workerCount < 0) {
+		workerCount = std::max(1, SDL_GetCPUCount() - 2);
+	}
+	if (workerCount == 0) {
+		return true;
+	}
+
+	mQuit = false;
+	mWake = SDL_CreateSemaphore(0);
+	for (int i = 0; i < workerCount; ++i) {
+		std::unique_ptr<Worker> worker(new Worker());
+		worker->system = this;
+		worker->index = i;
+		worker->thread = nullptr;
+		worker->first = 0;
+		worker->count = 0;
+		mWorkers.push_back(std::move(worker));
+	}
+
+	// Every queue exists before the first worker can try to steal from it
+	for (auto& worker : mWorkers) {
+		worker->thread = SDL_CreateThread(WorkerThread, "Worker", worker.get());
+		if (!worker->thread) {
+			SDL_Log("Failed to start a job worker: %s", SDL_GetError());
+			Shutdown();
+			return false;
+		}
+	}
+	return true;
+}
+
+void JobSystem::Shutdown()
+{
+	if (mWorkers.empty()) {
+		return;
+	}
+
+	mQuit = true;
+	for (size_t i = 0; i < mWorkers.size(); ++i) {
+		SDL_SemPost(mWake);
+	}
+	for (auto& worker : mWorkers) {
+		if (worker->thread) {
+			SDL_WaitThread(worker->thread, nullptr);
+		}
+	}
+	mWorkers.clear();
+
+	SDL_DestroySemaphore(mWake);
+	mWake = nullptr;
+}
+
+void JobSystem::Submit(JobFunction function, void* data, int begin, int end, JobCounter& counter)
+{
+	Job job = { function, data, begin, end, &counter };
+	counter.pending.fetch_add(1, std::memory_order_relaxed);
+
+	if (mWorkers.empty()) {
+		function(data, begin, end);
+		counter.pending.fetch_sub(1, std::memory_order_release);
+		return;
+	}
+
+	// Workers push onto their own queue, everyone else spreads jobs around
+	const int index = currentWorker >= 0 ? currentWorker : static_cast<int>(mNextQueue++ % mWorkers.size());
+	Worker& worker = *mWorkers[index];
+	bool queued = false;
+	{
+		std::lock_guard<std::mutex> lock(worker.mutex);
+		if (worker.count < jobQueueCapacity) {
+			worker.jobs[(worker.first + worker.count) % jobQueueCapacity] = job;
+			++worker.count;
+			queued = true;
+		}
+	}
+	if (!queued) {
+		function(data, begin, end); // Queue is full, the caller does the work
+		counter.pending.fetch_sub(1, std::memory_order_release);
+		return;
+	}
+	SDL_SemPost(mWake);
+}
+
+void JobSystem::Wait(JobCounter& counter)
+{
+	while (counter.pending.load(std::memory_order_acquire) > 0) {
+		if (!RunOneJob(currentWorker, &counter)) {
+			std::this_thread::yield(); // The last jobs are running elsewhere
+		}
+	}
+}
+
+int JobSystem::GetBatchSize(int count, int minBatchSize) const
+{
+	const int batches = (GetWorkerCount() + 1) * 4;
+	return std::max(minBatchSize, (count + batches - 1) / batches);
+}
+
+int SDLCALL JobSystem::WorkerThread(void* data)
+{
+	Worker* worker = static_cast<Worker*>(data);
+	worker->system->RunWorker(*worker);
+	return 0;
+}
+
+void JobSystem::RunWorker(Worker& worker)
+{
+	currentWorker = worker.index;
+	Profiler::Get().SetThreadName("Worker");
+
+	while (!mQuit) {
+		SDL_SemWait(mWake);
+		while (RunOneJob(worker.index, nullptr)) {
+		}
+	}
+}
+
+bool JobSystem::RunOneJob(int workerIndex, const JobCounter* counter)
+{
+	if (mWorkers.empty()) {
+		return false;
+	}
+
+	Job job;
+	bool found = false;
+	if (workerIndex >= 0) {
+		found = TakeJob(*mWorkers[workerIndex], true, counter, job);
+	}
+
+	// Steal, starting after our own queue so thieves spread out
+	const int count = static_cast<int>(mWorkers.size());
+	const int start = workerIndex >= 0 ? workerIndex + 1 : static_cast<int>(mNextQueue % count);
+	for (int i = 0; i < count && !found; ++i) {
+		const int victim = (start + i) % count;
+		if (victim != workerIndex) {
+			found = TakeJob(*mWorkers[victim], false, counter, job);
+		}
+	}
+	if (!found) {
+		return false;
+	}
+
+	job.function(job.data, job.begin, job.end);
+	job.counter->pending.fetch_sub(1, std::memory_order_release);
+	return true;
+}
+
+bool JobSystem::TakeJob(Worker& worker, bool newest, const JobCounter* counter, Job& job)
+{
+	std::lock_guard<std::mutex> lock(worker.mutex);
+	for (int i = 0; i < worker.count; ++i) {
+		const int offset = newest ? worker.count - 1 - i : i;
+		const Job& candidate = worker.jobs[(worker.first + offset) % jobQueueCapacity];
+		if (counter && candidate.counter != counter) {
+			continue;
+		}
+		job = candidate;
+
+		if (offset == 0) {
+			worker.first = (worker.first + 1) % jobQueueCapacity;
+		}
+		else {
+			// Taken from the middle, move the newer jobs down one slot
+			for (int next = offset + 1; next < worker.count; ++next) {
+				worker.jobs[(worker.first + next - 1) % jobQueueCapacity] = worker.jobs[(worker.first + next) % jobQueueCapacity];
+			}
+		}
+		--worker.count;
+		return true;
+	}
+	return false;
+}
+
+int TaskGraph::AddTask(const char* name, TaskFunction function)
+{
+	std::unique_ptr<Task> task(new Task());
+	task->function = function;
+	task->profileZone = Profiler::Get().RegisterZone(name);
+	task->dependencyCount = 0;
+	task->remaining = 0;
+	mTasks.push_back(std::move(task));
+	return static_cast<int>(mTasks.size()) - 1;
+}
+
+void TaskGraph::AddDependency(int before, int after)
+{
+	SDL_assert(before != after);
+	mTasks[before]->dependents.push_back(after);
+	++mTasks[after]->dependencyCount;
+}
+
+void TaskGraph::Run(JobSystem& jobs)
+{
+	mJobs = &jobs;
+	for (auto& task : mTasks) {
+		task->remaining.store(task->dependencyCount, std::memory_order_relaxed);
+	}
+
+	// Queue the tasks that depend on nothing, the rest follow from RunTask
+	for (int i = 0; i < static_cast<int>(mTasks.size()); ++i) {
+		if (mTasks[i]->dependencyCount == 0) {
+			jobs.Submit(RunTask, this, i, i + 1, mCounter);
+		}
+	}
+	jobs.Wait(mCounter);
+}
+
+void TaskGraph::RunTask(void* data, int index, int)
+{
+	TaskGraph* graph = static_cast<TaskGraph*>(data);
+	Task& task = *graph->mTasks[index];
+	{
+#if PROFILER_ENABLED
+		ProfileScope zone(task.profileZone);
+#endif
+		task.function();
+	}
+
+	// Submitted before this task's own job counts as finished, so Run can't
+	// see the counter hit zero while dependents are still to come
+	for (int dependent : task.dependents) {
+		if (graph->mTasks[dependent]->remaining.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+			graph->mJobs->Submit(RunTask, graph, dependent, dependent + 1, graph->mCounter);
+		}
+	}
+}
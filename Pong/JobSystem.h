@@ -0,0 +1,142 @@
+#pragma once
+#include "SDL/SDL.h"
+
+#include <algorithm>
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+// Counts the jobs of one batch that haven't finished yet
+struct JobCounter
+{
+	JobCounter() : pending(0) {}
+	std::atomic<int> pending;
+};
+
+// One unit of work: function(data, begin, end) on a range of items
+typedef void (*JobFunction)(void* data, int begin, int end);
+struct Job
+{
+	JobFunction function;
+	void* data;
+	int begin;
+	int end;
+	JobCounter* counter;
+};
+
+// Worker threads with one job queue each. A worker takes its own newest job
+// first (still warm in cache) and steals the oldest job of another worker
+// when it runs dry. Queues are fixed size rings, so submitting never
+// allocates; a job submitted to a full queue runs right away instead.
+// Threads that wait on a counter run that counter's jobs too, so waiting
+// inside a job (nested ParallelFor) doesn't deadlock. They never run other
+// jobs: the main and simulation threads share the workers, and a frame
+// waiting on its own batches mustn't pick up a whole simulation step.
+class JobSystem
+{
+public:
+	JobSystem();
+	~JobSystem();
+
+	// Start workerCount threads (-1 for one per core, leaving two for the
+	// main and simulation threads). With 0 workers everything runs inline.
+	bool Initialize(int workerCount = -1);
+	void Shutdown();
+
+	int GetWorkerCount() const { return static_cast<int>(mWorkers.size()); }
+
+	// Queue a job, counter.pending goes up by one until it finishes
+	void Submit(JobFunction function, void* data, int begin, int end, JobCounter& counter);
+
+	// Run the counter's jobs until every one of them has finished
+	void Wait(JobCounter& counter);
+
+	// Batch size that splits count items into a few batches per thread,
+	// never smaller than minBatchSize
+	int GetBatchSize(int count, int minBatchSize) const;
+
+	// Call function(begin, end) over [0, count) in batches of batchSize and
+	// wait for all of them. Batch n covers [n * batchSize, (n + 1) * batchSize).
+	template <typename Function>
+	void ParallelFor(int count, int batchSize, const Function& function)
+	{
+		if (count <= 0) {
+			return;
+		}
+		if (mWorkers.empty() || count <= batchSize) {
+			function(0, count); // Not worth a job
+			return;
+		}
+
+		JobCounter counter;
+		for (int begin = 0; begin < count; begin += batchSize) {
+			Submit(&CallRange<Function>, const_cast<Function*>(&function), begin, std::min(begin + batchSize, count), counter);
+		}
+		Wait(counter);
+	}
+
+private:
+	static const int jobQueueCapacity = 1024;
+
+	struct Worker
+	{
+		JobSystem* system;
+		int index;
+		SDL_Thread* thread;
+		std::mutex mutex; // Guards jobs, first and count
+		Job jobs[jobQueueCapacity]; // Ring, oldest job at first
+		int first;
+		int count;
+	};
+
+	template <typename Function>
+	static void CallRange(void* data, int begin, int end)
+	{
+		(*static_cast<const Function*>(data))(begin, end);
+	}
+
+	static int SDLCALL WorkerThread(void* worker);
+	void RunWorker(Worker& worker);
+	// Run one job of counter, or of any counter when it's null. workerIndex
+	// is -1 when not called from a worker.
+	bool RunOneJob(int workerIndex, const JobCounter* counter);
+	bool TakeJob(Worker& worker, bool newest, const JobCounter* counter, Job& job);
+
+	std::vector<std::unique_ptr<Worker>> mWorkers;
+	SDL_sem* mWake; // Posted once per submitted job
+	std::atomic<bool> mQuit;
+	std::atomic<unsigned> mNextQueue; // Round robin for jobs submitted from outside the workers
+};
+
+// Small dependency graph of frame phases. Build it once, Run it every frame:
+// each task is queued as soon as all the tasks it depends on finished.
+class TaskGraph
+{
+public:
+	typedef std::function<void()> TaskFunction;
+
+	// name is shown as the task's profiler zone
+	int AddTask(const char* name, TaskFunction function);
+	void AddDependency(int before, int after); // after starts once before finished
+
+	// Run every task once and wait for all of them
+	void Run(JobSystem& jobs);
+
+private:
+	struct Task
+	{
+		TaskFunction function;
+		int profileZone;
+		std::vector<int> dependents;
+		int dependencyCount;
+		std::atomic<int> remaining; // Dependencies not finished yet this run
+	};
+
+	static void RunTask(void* graph, int task, int);
+
+	std::vector<std::unique_ptr<Task>> mTasks;
+	JobSystem* mJobs;
+	JobCounter mCounter;
+};
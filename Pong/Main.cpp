@@ -1,9 +1,130 @@
 #include "Game.h"
+#include "AssetArchive.h"
+#include "AudioConvert.h"
+#include "Benchmark.h"
+
+#include <climits>
+#include <cstdlib>
+#include <cstring>
 
 int main(int argc, char** argv)
 {
+	if (argc > 1 && strcmp(argv[1], "--bench-collision") == 0)
+	{
+		RunCollisionBenchmark();
+		return 0;
+	}
+	if (argc > 1 && strcmp(argv[1], "--bench-jobs") == 0)
+	{
+		RunJobBenchmark();
+		return 0;
+	}
+	if (argc > 3 && strcmp(argv[1], "--convert-audio") == 0)
+	{
+		// Build step: --convert-audio <in.wav> <out.pcm>
+		return ConvertSound(argv[2], argv[3], audioFrequency, audioFormat, audioChannels) ? 0 : 1;
+	}
+	if (argc > 3 && strcmp(argv[1], "--pack") == 0)
+	{
+		// Build step: --pack <archive> <file>...
+		return PackAssets(argv[2], argv + 3, argc - 3) ? 0 : 1;
+	}
+	if (argc > 1 && strcmp(argv[1], "--bench-audio") == 0)
+	{
+		RunAudioBenchmark();
+		return 0;
+	}
+
 	Game game;
+
+	// --fps <rate> sets the frame cap (0 for uncapped, VSync still applies)
+	// --headless runs a benchmark without a window, --frames <count> sets its length
+	// --seed <n> seeds startup randomness, --record/--replay <file> record or play back input
+	// --pickups <count> scatters that many block pickups over the map
+	// --trace <file> [frames] writes a Chrome trace of the first frames (default 300)
+	bool headless = false;
+	int headlessFrames = 1000;
+	bool framesGiven = false;
+	const char* recordPath = nullptr;
+	const char* replayPath = nullptr;
+	const char* tracePath = nullptr;
+	int traceFrames = 300;
+	for (int i = 1; i < argc; ++i)
+	{
+		if (strcmp(argv[i], "--fps") == 0 && i + 1 < argc)
+		{
+			game.SetTargetFrameRate(atoi(argv[++i]));
+		}
+		else if (strcmp(argv[i], "--headless") == 0)
+		{
+			headless = true;
+		}
+		else if (strcmp(argv[i], "--frames") == 0 && i + 1 < argc)
+		{
+			headlessFrames = atoi(argv[++i]);
+			framesGiven = true;
+			if (headlessFrames < 0)
+			{
+				SDL_Log("--frames needs a count of 0 or more");
+				return 1;
+			}
+		}
+		else if (strcmp(argv[i], "--seed") == 0 && i + 1 < argc)
+		{
+			game.SetSeed(static_cast<Uint32>(strtoul(argv[++i], nullptr, 10)));
+		}
+		else if (strcmp(argv[i], "--pickups") == 0 && i + 1 < argc)
+		{
+			game.SetPickupCount(atoi(argv[++i]));
+		}
+		else if (strcmp(argv[i], "--record") == 0 && i + 1 < argc)
+		{
+			recordPath = argv[++i];
+		}
+		else if (strcmp(argv[i], "--replay") == 0 && i + 1 < argc)
+		{
+			replayPath = argv[++i];
+		}
+		else if (strcmp(argv[i], "--trace") == 0 && i + 1 < argc)
+		{
+			tracePath = argv[++i];
+			if (i + 1 < argc && argv[i + 1][0] != '-')
+			{
+				traceFrames = atoi(argv[++i]);
+			}
+		}
+	}
+
+	if (replayPath)
+	{
+		if (!game.StartReplay(replayPath))
+		{
+			return 1;
+		}
+	}
+	else if (recordPath)
+	{
+		if (!game.StartRecording(recordPath))
+		{
+			return 1;
+		}
+	}
+
+	if (headless)
+	{
+		// A headless replay runs to the end of the recording unless told otherwise
+		if (replayPath && !framesGiven)
+		{
+			headlessFrames = INT_MAX;
+		}
+		game.SetHeadless(headlessFrames);
+	}
+
 	bool success = game.Initialize();
+	if (success && tracePath)
+	{
+		game.StartTrace(tracePath, traceFrames);
+	}
 	if (success)
 	{
 		game.RunLoop();
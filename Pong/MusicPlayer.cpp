@@ -0,0 +1,131 @@
+#include "MusicPlayer.h"
+
+std::atomic<bool> MusicPlayer::trackFinished(false);
+
+MusicPlayer::MusicPlayer()
+	: mCurrent(-1)
+	, mMusic(nullptr)
+	, mFadeMilliseconds(0)
+	, mArchive(nullptr)
+{
+}
+
+bool MusicPlayer::Initialize(const char* directory, int fadeMilliseconds, const AssetArchive* archive)
+{
+	mFadeMilliseconds = fadeMilliseconds;
+	mArchive = archive;
+	mTracks.clear();
+
+	const std::string prefix = std::string(directory) + "/";
+	const std::string playlist = prefix + "Playlist.txt";
+	SDL_RWops* file = archive ? archive->OpenEntry(playlist.c_str()) : nullptr;
+	if (!file) {
+		file = SDL_RWFromFile(playlist.c_str(), "rb");
+	}
+	if (!file) {
+		SDL_Log("Failed to open the playlist in %s: %s", directory, SDL_GetError());
+		return false;
+	}
+
+	// Small text file, read it whole and split it into lines
+	std::string text;
+	char buffer[512];
+	size_t read;
+	while ((read = SDL_RWread(file, buffer, 1, sizeof(buffer))) > 0) {
+		text.append(buffer, read);
+	}
+	SDL_RWclose(file);
+
+	size_t start = 0;
+	while (start < text.size()) {
+		size_t end = text.find('\n', start);
+		if (end == std::string::npos) {
+			end = text.size();
+		}
+		std::string line = text.substr(start, end - start);
+		start = end + 1;
+
+		while (!line.empty() && (line.back() == '\r' || line.back() == ' ' || line.back() == '\t')) {
+			line.pop_back();
+		}
+		if (!line.empty() && line[0] != '#') {
+			mTracks.push_back(prefix + line);
+		}
+	}
+
+	if (mTracks.empty()) {
+		SDL_Log("The playlist in %s has no tracks", directory);
+		return false;
+	}
+
+	Mix_HookMusicFinished(OnMusicFinished);
+	return true;
+}
+
+void MusicPlayer::Shutdown()
+{
+	Mix_HookMusicFinished(nullptr);
+	if (mMusic) {
+		Mix_HaltMusic();
+		Mix_FreeMusic(mMusic);
+		mMusic = nullptr;
+	}
+	mTracks.clear();
+	mCurrent = -1;
+}
+
+void MusicPlayer::Play()
+{
+	if (!mTracks.empty()) {
+		StartTrack(0);
+	}
+}
+
+void MusicPlayer::Next()
+{
+	if (mMusic && Mix_PlayingMusic()) {
+		Mix_FadeOutMusic(mFadeMilliseconds); // OnMusicFinished fires when it's silent
+	}
+	else if (!mTracks.empty()) {
+		StartTrack((mCurrent + 1) % GetTrackCount());
+	}
+}
+
+void MusicPlayer::Update()
+{
+	if (trackFinished.exchange(false)) {
+		StartTrack((mCurrent + 1) % GetTrackCount());
+	}
+}
+
+bool MusicPlayer::StartTrack(int index)
+{
+	if (mMusic) {
+		Mix_HaltMusic();
+		Mix_FreeMusic(mMusic);
+		mMusic = nullptr;
+	}
+	trackFinished = false;
+
+	mCurrent = index;
+	// A packed track streams from the mapping, paged in as it plays
+	SDL_RWops* packed = mArchive ? mArchive->OpenEntry(mTracks[index].c_str()) : nullptr;
+	mMusic = packed ? Mix_LoadMUS_RW(packed, 1) : Mix_LoadMUS(mTracks[index].c_str());
+	if (!mMusic) {
+		SDL_Log("Failed to open %s: %s", mTracks[index].c_str(), Mix_GetError());
+		return false;
+	}
+
+	// One track loops by itself, otherwise play it once and move on
+	const int loops = GetTrackCount() == 1 ? -1 : 1;
+	if (Mix_FadeInMusic(mMusic, loops, mFadeMilliseconds) < 0) {
+		SDL_Log("Failed to play %s: %s", mTracks[index].c_str(), Mix_GetError());
+		return false;
+	}
+	return true;
+}
+
+void SDLCALL MusicPlayer::OnMusicFinished()
+{
+	trackFinished = true;
+}
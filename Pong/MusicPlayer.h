@@ -0,0 +1,56 @@
+#pragma once
+#include "SDL/SDL.h"
+#include "AssetArchive.h"
+
+#include <SDL/SDL_mixer.h>
+
+#include <atomic>
+#include <string>
+#include <vector>
+
+// Background music from a playlist, streamed with Mix_Music: the file is
+// decoded a buffer at a time as it plays, so memory doesn't grow with the
+// length of a track and only one track is open at once. A single track
+// loops forever; with several, each plays once and the next one follows.
+//
+// SDL_mixer only plays one music stream at a time, so switching tracks
+// fades the old one out and then the new one in rather than overlapping
+// the two.
+class MusicPlayer
+{
+public:
+	MusicPlayer();
+
+	// Read directory/Playlist.txt, one track file name per line (blank
+	// lines and lines starting with # are skipped). Call after Mix_OpenAudio.
+	// The playlist and tracks come from the archive when it has them; it
+	// must stay open until after Shutdown.
+	bool Initialize(const char* directory, int fadeMilliseconds, const AssetArchive* archive = nullptr);
+	void Shutdown();
+
+	// Fade in the first track
+	void Play();
+
+	// Fade out the current track, the next one fades in after it
+	void Next();
+
+	// Start the next track once the current one finished. Call every frame,
+	// from the thread that called Play.
+	void Update();
+
+	int GetTrackCount() const { return static_cast<int>(mTracks.size()); }
+
+private:
+	bool StartTrack(int index);
+	static void SDLCALL OnMusicFinished(); // Audio thread
+
+	std::vector<std::string> mTracks; // Full paths
+	int mCurrent;
+	Mix_Music* mMusic;
+	int mFadeMilliseconds;
+	const AssetArchive* mArchive;
+
+	// Set by OnMusicFinished, SDL_mixer's hook takes no user data and
+	// mustn't call back into the mixer itself
+	static std::atomic<bool> trackFinished;
+};
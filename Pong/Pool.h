@@ -0,0 +1,124 @@
+#pragma once
+#include "SDL/SDL.h"
+
+#include <algorithm>
+#include <vector>
+
+// Handle to an object in a Pool. Like Entity, the generation tells a live
+// object apart from an older one that used the same slot.
+struct PoolHandle
+{
+	Uint32 index;
+	Uint32 generation;
+
+	bool operator==(const PoolHandle& other) const { return index == other.index && generation == other.generation; }
+	bool operator!=(const PoolHandle& other) const { return !(*this == other); }
+};
+
+const PoolHandle nullPoolHandle = { 0xFFFFFFFF, 0 };
+
+// Fixed number of T slots, allocated once up front. Free slots are linked
+// through their nextFree index, so Create and Destroy are O(1) and never
+// touch the heap. Objects never move: pointers from Get stay valid until
+// the object is destroyed, and handles never dangle.
+template <typename T>
+class Pool
+{
+public:
+	explicit Pool(int capacity)
+		: mSlots(capacity)
+		, mFirstFree(capacity > 0 ? 0 : -1)
+		, mCount(0)
+		, mUsedSlots(0)
+	{
+		for (int i = 0; i < capacity; ++i) {
+			mSlots[i].generation = 0;
+			mSlots[i].nextFree = i + 1 < capacity ? i + 1 : -1;
+			mSlots[i].alive = false;
+		}
+	}
+
+	// nullPoolHandle when every slot is taken
+	PoolHandle Create(const T& value)
+	{
+		if (mFirstFree < 0) {
+			return nullPoolHandle;
+		}
+		const int index = mFirstFree;
+		Slot& slot = mSlots[index];
+		mFirstFree = slot.nextFree;
+		slot.value = value;
+		slot.alive = true;
+		++mCount;
+		mUsedSlots = std::max(mUsedSlots, index + 1);
+
+		PoolHandle handle = { static_cast<Uint32>(index), slot.generation };
+		return handle;
+	}
+
+	void Destroy(PoolHandle handle)
+	{
+		if (!IsAlive(handle)) {
+			return;
+		}
+		Slot& slot = mSlots[handle.index];
+		slot.alive = false;
+		++slot.generation; // Outstanding handles go stale
+		slot.nextFree = mFirstFree;
+		mFirstFree = static_cast<int>(handle.index);
+		--mCount;
+	}
+
+	bool IsAlive(PoolHandle handle) const
+	{
+		return handle.index < mSlots.size() && mSlots[handle.index].alive && mSlots[handle.index].generation == handle.generation;
+	}
+
+	// nullptr for a stale handle
+	T* Get(PoolHandle handle) { return IsAlive(handle) ? &mSlots[handle.index].value : nullptr; }
+	const T* Get(PoolHandle handle) const { return IsAlive(handle) ? &mSlots[handle.index].value : nullptr; }
+
+	// Call function(handle, object) for every live object. The function may
+	// Destroy the object it was given (but no other). Freed slots are reused
+	// newest first, so this only walks up to the highest slot ever used.
+	template <typename Function>
+	void ForEach(const Function& function)
+	{
+		for (int i = 0; i < mUsedSlots; ++i) {
+			Slot& slot = mSlots[i];
+			if (slot.alive) {
+				PoolHandle handle = { static_cast<Uint32>(i), slot.generation };
+				function(handle, slot.value);
+			}
+		}
+	}
+
+	template <typename Function>
+	void ForEach(const Function& function) const
+	{
+		for (int i = 0; i < mUsedSlots; ++i) {
+			const Slot& slot = mSlots[i];
+			if (slot.alive) {
+				PoolHandle handle = { static_cast<Uint32>(i), slot.generation };
+				function(handle, slot.value);
+			}
+		}
+	}
+
+	int GetCount() const { return mCount; }
+	int GetCapacity() const { return static_cast<int>(mSlots.size()); }
+
+private:
+	struct Slot
+	{
+		T value;
+		Uint32 generation;
+		int nextFree; // Next free slot while this one is free, -1 at the end of the list
+		bool alive;
+	};
+
+	std::vector<Slot> mSlots;
+	int mFirstFree; // Head of the free list, -1 when full
+	int mCount;
+	int mUsedSlots; // One past the highest slot that was ever alive
+};
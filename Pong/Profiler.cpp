@@ -0,0 +1,323 @@
+#include "Profiler.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+
+namespace
+{
+	// Open zones on this thread, innermost last
+	struct ProfileStackEntry
+	{
+		int zone;
+		Uint64 start;
+		Uint64 childTicks; // Time spent in nested zones
+	};
+
+	const int maxProfileDepth = 32;
+
+	struct ProfileStack
+	{
+		ProfileStackEntry entries[maxProfileDepth];
+		int depth;
+	};
+
+	thread_local ProfileStack profileStack;
+	thread_local void* traceBuffer; // Profiler::TraceBuffer of this thread
+	thread_local int profileThread = -1; // Index into the per-thread times, -1 until first use
+}
+
+Profiler& Profiler::Get()
+{
+	static Profiler profiler;
+	return profiler;
+}
+
+Profiler::Profiler()
+	: mZoneCount(0)
+	, mThreadCount(0)
+	, mCapturing(false)
+{
+	for (int i = 0; i < maxProfileZones; ++i) {
+		mNames[i] = "";
+	}
+	for (int thread = 0; thread < maxProfileThreads; ++thread) {
+		for (int i = 0; i < maxProfileZones; ++i) {
+			mCurrent[thread][i].store(0);
+		}
+	}
+	mFrameThread = 0;
+	memset(mHistory, 0, sizeof(mHistory));
+	memset(mFrameTimes, 0, sizeof(mFrameTimes));
+	mNewest = 0;
+	mFrames = 0;
+	mFrameStart = SDL_GetPerformanceCounter();
+	mTicksToMs = 1000.0 / SDL_GetPerformanceFrequency();
+	mTraceBuffersSized = false;
+	mTraceFramesLeft = 0;
+	mTraceStart = 0;
+}
+
+int Profiler::RegisterZone(const char* name)
+{
+	std::lock_guard<std::mutex> lock(mRegisterMutex);
+
+	// Same name from another call site shares the zone
+	const int count = mZoneCount.load();
+	for (int i = 0; i < count; ++i) {
+		if (strcmp(mNames[i], name) == 0) {
+			return i;
+		}
+	}
+
+	SDL_assert(count < maxProfileZones);
+	if (count >= maxProfileZones) {
+		return maxProfileZones - 1;
+	}
+	mNames[count] = name;
+	mZoneCount.store(count + 1);
+	return count;
+}
+
+int Profiler::RegisterThread(const char* name)
+{
+	std::lock_guard<std::mutex> lock(mRegisterMutex);
+
+	// Same name from another thread shares the times (the job workers)
+	const int count = mThreadCount.load(std::memory_order_relaxed);
+	for (int i = 0; i < count; ++i) {
+		if (mThreadNames[i] == name) {
+			return i;
+		}
+	}
+
+	SDL_assert(count < maxProfileThreads);
+	if (count >= maxProfileThreads) {
+		return maxProfileThreads - 1;
+	}
+	mThreadNames[count] = name;
+	mThreadCount.store(count + 1, std::memory_order_release);
+	return count;
+}
+
+int Profiler::GetThreadIndex()
+{
+	if (profileThread < 0) {
+		profileThread = RegisterThread("Thread");
+	}
+	return profileThread;
+}
+
+void Profiler::BeginZone(int zone)
+{
+	ProfileStack& stack = profileStack;
+	SDL_assert(stack.depth < maxProfileDepth);
+	if (stack.depth >= maxProfileDepth) {
+		return;
+	}
+
+	ProfileStackEntry& entry = stack.entries[stack.depth++];
+	entry.zone = zone;
+	entry.start = SDL_GetPerformanceCounter();
+	entry.childTicks = 0;
+}
+
+void Profiler::EndZone(int zone)
+{
+	const Uint64 now = SDL_GetPerformanceCounter();
+	ProfileStack& stack = profileStack;
+	SDL_assert(stack.depth > 0 && stack.entries[stack.depth - 1].zone == zone);
+	if (stack.depth <= 0) {
+		return;
+	}
+
+	const ProfileStackEntry& entry = stack.entries[--stack.depth];
+	const Uint64 elapsed = now - entry.start;
+	mCurrent[GetThreadIndex()][zone].fetch_add(elapsed - entry.childTicks, std::memory_order_relaxed);
+	if (mCapturing.load(std::memory_order_acquire)) { // Acquire: StartCapture sized the buffer before setting it
+		AddTraceEvent(mNames[zone], entry.start, now);
+	}
+
+	if (stack.depth > 0) {
+		stack.entries[stack.depth - 1].childTicks += elapsed;
+	}
+}
+
+void Profiler::EndFrame()
+{
+	const Uint64 now = SDL_GetPerformanceCounter();
+
+	mFrameThread = GetThreadIndex();
+	mNewest = (mNewest + 1) % profileHistorySize;
+	for (int thread = 0; thread < maxProfileThreads; ++thread) {
+		for (int i = 0; i < maxProfileZones; ++i) {
+			const Uint64 ticks = mCurrent[thread][i].exchange(0, std::memory_order_relaxed);
+			mHistory[mNewest][thread][i] = static_cast<float>(ticks * mTicksToMs);
+		}
+	}
+	mFrameTimes[mNewest] = static_cast<float>((now - mFrameStart) * mTicksToMs);
+
+	if (mCapturing.load(std::memory_order_acquire)) {
+		AddTraceEvent("Frame", mFrameStart, now);
+		if (mTraceFramesLeft > 0 && --mTraceFramesLeft == 0) {
+			StopCapture();
+		}
+	}
+	mFrameStart = now;
+
+	if (mFrames < profileHistorySize) {
+		++mFrames;
+	}
+}
+
+int Profiler::HistorySlot(int framesAgo) const
+{
+	return (mNewest - framesAgo + profileHistorySize) % profileHistorySize;
+}
+
+float Profiler::GetZoneTime(int framesAgo, int thread, int zone) const
+{
+	return mHistory[HistorySlot(framesAgo)][thread][zone];
+}
+
+float Profiler::GetFrameTime(int framesAgo) const
+{
+	return mFrameTimes[HistorySlot(framesAgo)];
+}
+
+void Profiler::SetThreadName(const char* name)
+{
+	profileThread = RegisterThread(name);
+
+	TraceBuffer* buffer = GetTraceBuffer();
+	std::lock_guard<std::mutex> lock(mTraceMutex);
+	buffer->threadName = name;
+}
+
+Profiler::TraceBuffer* Profiler::GetTraceBuffer()
+{
+	if (!traceBuffer) {
+		// First use on this thread, the only time recording takes the lock
+		std::unique_ptr<TraceBuffer> buffer(new TraceBuffer());
+		buffer->threadId = SDL_ThreadID();
+		buffer->threadName = "Thread";
+		buffer->count.store(0, std::memory_order_relaxed);
+		buffer->dropped.store(0, std::memory_order_relaxed);
+		traceBuffer = buffer.get();
+
+		std::lock_guard<std::mutex> lock(mTraceMutex);
+		if (mTraceBuffersSized) {
+			buffer->events.resize(traceBufferSize); // Thread started after the first capture
+		}
+		mTraceBuffers.push_back(std::move(buffer));
+	}
+	return static_cast<TraceBuffer*>(traceBuffer);
+}
+
+void Profiler::AddTraceEvent(const char* name, Uint64 start, Uint64 end)
+{
+	TraceBuffer* buffer = GetTraceBuffer();
+	const int count = buffer->count.load(std::memory_order_acquire);
+	if (count >= static_cast<int>(buffer->events.size())) {
+		buffer->dropped.fetch_add(1, std::memory_order_release);
+		return;
+	}
+
+	TraceEvent& event = buffer->events[count];
+	event.name = name;
+	event.start = start;
+	event.end = end;
+	buffer->count.store(count + 1, std::memory_order_release);
+}
+
+void Profiler::StartCapture(const char* path, int frameCount)
+{
+	if (IsCapturing()) {
+		return;
+	}
+
+	{
+		// Allocated on the first capture and kept, mCapturing publishes them
+		std::lock_guard<std::mutex> lock(mTraceMutex);
+		for (auto& buffer : mTraceBuffers) {
+			buffer->events.resize(traceBufferSize);
+			buffer->count.store(0, std::memory_order_release);
+			buffer->dropped.store(0, std::memory_order_release);
+		}
+		mTraceBuffersSized = true;
+	}
+
+	mTracePath = path;
+	mTraceFramesLeft = frameCount;
+	mTraceStart = SDL_GetPerformanceCounter();
+	mCapturing.store(true, std::memory_order_release);
+	SDL_Log("Trace capture started (%s)", path);
+}
+
+void Profiler::StopCapture()
+{
+	if (!IsCapturing()) {
+		return;
+	}
+	mCapturing.store(false);
+
+	if (WriteTrace()) {
+		SDL_Log("Trace written to %s", mTracePath.c_str());
+	}
+}
+
+bool Profiler::WriteTrace()
+{
+	SDL_RWops* file = SDL_RWFromFile(mTracePath.c_str(), "wb");
+	if (!file) {
+		SDL_Log("Unable to write trace %s: %s", mTracePath.c_str(), SDL_GetError());
+		return false;
+	}
+
+	const double ticksToUs = mTicksToMs * 1000.0;
+	char line[256];
+	bool first = true;
+	auto write = [&](int length) {
+		length = std::min(length, static_cast<int>(sizeof(line)) - 1);
+		SDL_RWwrite(file, first ? line + 1 : line, 1, first ? length - 1 : length); // No comma before the first event
+		first = false;
+	};
+
+	const char header[] = "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+	SDL_RWwrite(file, header, 1, sizeof(header) - 1);
+
+	std::lock_guard<std::mutex> lock(mTraceMutex);
+	for (const auto& buffer : mTraceBuffers) {
+		const int count = buffer->count.load(std::memory_order_acquire);
+		if (count == 0) {
+			continue;
+		}
+
+		// Thread name metadata
+		write(snprintf(line, sizeof(line),
+			",{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%lu,\"args\":{\"name\":\"%s\"}}\n",
+			static_cast<unsigned long>(buffer->threadId), buffer->threadName.c_str()));
+
+		// Complete events, timestamps in microseconds from the start of the capture
+		for (int i = 0; i < count; ++i) {
+			const TraceEvent& event = buffer->events[i];
+			if (event.start < mTraceStart) {
+				continue; // Zone began before the capture did
+			}
+			write(snprintf(line, sizeof(line),
+				",{\"name\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":%lu,\"ts\":%.3f,\"dur\":%.3f}\n",
+				event.name, static_cast<unsigned long>(buffer->threadId),
+				(event.start - mTraceStart) * ticksToUs, (event.end - event.start) * ticksToUs));
+		}
+
+		const int dropped = buffer->dropped.load(std::memory_order_acquire);
+		if (dropped > 0) {
+			SDL_Log("Trace: %d events dropped on thread %s (buffer full)", dropped, buffer->threadName.c_str());
+		}
+	}
+
+	const char footer[] = "]}\n";
+	SDL_RWwrite(file, footer, 1, sizeof(footer) - 1);
+	SDL_RWclose(file);
+	return true;
+}
@@ -0,0 +1,158 @@
+#pragma once
+#include "SDL/SDL.h"
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// Build with PROFILER_ENABLED=0 to compile every zone out
+#ifndef PROFILER_ENABLED
+#define PROFILER_ENABLED 1
+#endif
+
+const int maxProfileZones = 32;
+const int maxProfileThreads = 8; // Thread names, threads sharing a name share their times
+const int profileHistorySize = 240; // Frames kept for the overlay graph
+const int traceBufferSize = 1 << 16; // Events per thread per capture
+
+// Frame profiler. Zones are timed with SDL_GetPerformanceCounter and can
+// nest; each zone is charged its exclusive time (minus child zones). Times
+// are kept per thread name, so the zones of the thread that ends frames
+// stack up to the frame's total and other threads (simulation, workers)
+// are kept apart. The last profileHistorySize frames are kept in a ring
+// buffer.
+//
+// A trace capture additionally records every zone as a begin/end event
+// and writes them out as Chrome trace-event JSON (chrome://tracing or
+// ui.perfetto.dev). Each thread appends to its own buffer, so recording
+// takes no locks.
+class Profiler
+{
+public:
+	static Profiler& Get();
+
+	// Zone IDs are handed out once per call site (see PROFILE_ZONE)
+	int RegisterZone(const char* name);
+
+	void BeginZone(int zone);
+	void EndZone(int zone);
+
+	// Close the current frame and move it into the history
+	void EndFrame();
+
+	int GetZoneCount() const { return mZoneCount.load(); }
+	const char* GetZoneName(int zone) const { return mNames[zone]; }
+
+	// Frames in the history (up to profileHistorySize)
+	int GetFrameCount() const { return mFrames; }
+
+	// Threads that recorded zones, by name. Unnamed threads share "Thread".
+	int GetThreadCount() const { return mThreadCount.load(std::memory_order_acquire); }
+	const char* GetThreadName(int thread) const { return mThreadNames[thread].c_str(); }
+
+	// The thread that calls EndFrame, its zones add up to the frame time
+	int GetFrameThread() const { return mFrameThread; }
+
+	// Milliseconds, framesAgo = 0 is the last completed frame
+	float GetZoneTime(int framesAgo, int thread, int zone) const;
+	float GetFrameTime(int framesAgo) const;
+
+	// Name the calling thread in the graph and in traces
+	void SetThreadName(const char* name);
+
+	// Record zones for frameCount frames (0 until StopCapture), then write
+	// the trace to path
+	void StartCapture(const char* path, int frameCount);
+	void StopCapture();
+	bool IsCapturing() const { return mCapturing.load(std::memory_order_relaxed); }
+
+private:
+	// Completed zone, in performance counter ticks
+	struct TraceEvent
+	{
+		const char* name;
+		Uint64 start;
+		Uint64 end;
+	};
+
+	// One per thread that was named or ever recorded an event. Only the
+	// owning thread writes events; the count is published with release so
+	// the writer sees complete events. StartCapture resets count and dropped
+	// from another thread, so both are atomic. events stays empty until the first
+	// capture, so runs that never capture don't pay for the memory.
+	struct TraceBuffer
+	{
+		SDL_threadID threadId;
+		std::string threadName;
+		std::vector<TraceEvent> events; // traceBufferSize once a capture started
+		std::atomic<int> count;
+		std::atomic<int> dropped; // Events that didn't fit this capture
+	};
+
+	Profiler();
+
+	int HistorySlot(int framesAgo) const;
+
+	int RegisterThread(const char* name);
+	int GetThreadIndex();
+
+	TraceBuffer* GetTraceBuffer();
+	void AddTraceEvent(const char* name, Uint64 start, Uint64 end);
+	bool WriteTrace();
+
+	std::mutex mRegisterMutex;
+	const char* mNames[maxProfileZones];
+	std::atomic<int> mZoneCount;
+
+	// Written before mThreadCount is raised past them, under mRegisterMutex
+	std::string mThreadNames[maxProfileThreads];
+	std::atomic<int> mThreadCount;
+	int mFrameThread;
+
+	// Exclusive ticks per thread and zone for the frame in progress
+	std::atomic<Uint64> mCurrent[maxProfileThreads][maxProfileZones];
+
+	float mHistory[profileHistorySize][maxProfileThreads][maxProfileZones];
+	float mFrameTimes[profileHistorySize];
+	int mNewest; // Slot of the last completed frame
+	int mFrames;
+
+	Uint64 mFrameStart;
+	double mTicksToMs;
+
+	// Trace capture
+	std::mutex mTraceMutex; // Guards mTraceBuffers and mTraceBuffersSized
+	std::vector<std::unique_ptr<TraceBuffer>> mTraceBuffers;
+	bool mTraceBuffersSized; // A capture has started, new buffers get their events up front
+	std::atomic<bool> mCapturing;
+	std::string mTracePath;
+	int mTraceFramesLeft; // 0 when the capture has no frame limit
+	Uint64 mTraceStart;
+};
+
+// Times a zone from construction to the end of the enclosing scope
+class ProfileScope
+{
+public:
+	explicit ProfileScope(int zone) : mZone(zone) { Profiler::Get().BeginZone(zone); }
+	~ProfileScope() { Profiler::Get().EndZone(mZone); }
+
+private:
+	int mZone;
+};
+
+#define PROFILE_CONCAT_INNER(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_INNER(a, b)
+
+#if PROFILER_ENABLED
+// Time the rest of the current scope as the named zone
+#define PROFILE_ZONE(name) \
+	static const int PROFILE_CONCAT(profileZoneId, __LINE__) = Profiler::Get().RegisterZone(name); \
+	ProfileScope PROFILE_CONCAT(profileZone, __LINE__)(PROFILE_CONCAT(profileZoneId, __LINE__))
+#define PROFILE_END_FRAME() Profiler::Get().EndFrame()
+#else
+#define PROFILE_ZONE(name) ((void)0)
+#define PROFILE_END_FRAME() ((void)0)
+#endif
@@ -0,0 +1,228 @@
+#include "ProfilerOverlay.h"
+
+#include <algorithm>
+#include <cstdio>
+
+// Overlay layout (screen pixels)
+const int overlayX = 10;
+const int overlayY = 10;
+const int barWidth = 2;
+const int graphHeight = 150;
+const int threadGraphHeight = 75; // Other threads, under the frame graph
+const int threadGraphGap = 6;
+const float pixelsPerMs = 4.5f; // 33 ms fills the graph
+const int legendX = overlayX + profileHistorySize * barWidth + 10;
+const int lineHeight = 16;
+
+// Zone colors, repeated when there are more zones than colors
+const SDL_Color zoneColors[] = {
+	{ 230, 25, 75, 255 },
+	{ 60, 180, 75, 255 },
+	{ 255, 225, 25, 255 },
+	{ 0, 130, 200, 255 },
+	{ 245, 130, 48, 255 },
+	{ 145, 30, 180, 255 },
+	{ 70, 240, 240, 255 },
+	{ 240, 50, 230, 255 },
+	{ 210, 245, 60, 255 },
+	{ 250, 190, 190, 255 },
+	{ 0, 128, 128, 255 },
+	{ 170, 110, 40, 255 }
+};
+const int zoneColorCount = sizeof(zoneColors) / sizeof(zoneColors[0]);
+
+// Fonts to try, first one that opens wins
+const char* const fontPaths[] = {
+	"Font.ttf",
+	"C:/Windows/Fonts/consola.ttf",
+	"C:/Windows/Fonts/arial.ttf",
+	"/usr/share/fonts/truetype/dejavu/DejaVuSansMono.ttf",
+	"/System/Library/Fonts/Menlo.ttc"
+};
+
+ProfilerOverlay::ProfilerOverlay()
+{
+	mVisible = false;
+	mFont = nullptr;
+}
+
+void ProfilerOverlay::Initialize()
+{
+	if (TTF_Init() != 0) {
+		SDL_Log("Profiler overlay: unable to initialize SDL_ttf: %s", TTF_GetError());
+		return;
+	}
+
+	for (const char* path : fontPaths) {
+		mFont = TTF_OpenFont(path, 12);
+		if (mFont) {
+			break;
+		}
+	}
+	if (!mFont) {
+		SDL_Log("Profiler overlay: no font found, drawing the graph without text");
+	}
+}
+
+void ProfilerOverlay::Shutdown()
+{
+	if (mFont) {
+		TTF_CloseFont(mFont);
+		mFont = nullptr;
+	}
+	if (TTF_WasInit()) {
+		TTF_Quit();
+	}
+}
+
+void ProfilerOverlay::SetStatusLine(int line, const std::string& text)
+{
+	if (line >= static_cast<int>(mStatusLines.size())) {
+		mStatusLines.resize(line + 1);
+	}
+	mStatusLines[line] = text;
+}
+
+void ProfilerOverlay::Draw(RenderLayers& layers)
+{
+	if (!mVisible) {
+		return;
+	}
+
+	const Profiler& profiler = Profiler::Get();
+	const int zoneCount = profiler.GetZoneCount();
+	const int frames = profiler.GetFrameCount();
+
+	// The thread that ends frames on top, its zones add up to the frame time.
+	// Other threads run alongside it, each gets its own graph below.
+	const int frameThread = profiler.GetFrameThread();
+	DrawGraph(layers, frameThread, overlayY, graphHeight);
+	int graphY = overlayY + graphHeight + threadGraphGap;
+	for (int thread = 0; thread < profiler.GetThreadCount(); ++thread) {
+		if (thread != frameThread && HasZoneTime(thread)) {
+			DrawGraph(layers, thread, graphY, threadGraphHeight);
+			graphY += threadGraphHeight + threadGraphGap;
+		}
+	}
+
+	// Legend: zone color, name and average over the last second or so, all threads
+	const int averageFrames = std::min(frames, 60);
+	int y = overlayY;
+	for (int zone = 0; zone < zoneCount; ++zone) {
+		layers.SetDrawColor(zoneColors[zone % zoneColorCount]);
+		SDL_Rect swatch = { legendX, y + 3, 10, 10 };
+		layers.FillRect(swatch);
+
+		if (mFont) {
+			float total = 0.0f;
+			for (int i = 0; i < averageFrames; ++i) {
+				for (int thread = 0; thread < profiler.GetThreadCount(); ++thread) {
+					total += profiler.GetZoneTime(i, thread, zone);
+				}
+			}
+			char text[96];
+			snprintf(text, sizeof(text), "%-14s %6.3f ms", profiler.GetZoneName(zone),
+				averageFrames > 0 ? total / averageFrames : 0.0f);
+			DrawText(layers, text, legendX + 14, y);
+		}
+		y += lineHeight;
+	}
+
+	if (mFont) {
+		float total = 0.0f;
+		for (int i = 0; i < averageFrames; ++i) {
+			total += profiler.GetFrameTime(i);
+		}
+		char text[64];
+		snprintf(text, sizeof(text), "Frame          %6.3f ms", averageFrames > 0 ? total / averageFrames : 0.0f);
+		DrawText(layers, text, legendX + 14, y);
+		y += lineHeight;
+
+		for (const std::string& line : mStatusLines) {
+			DrawText(layers, line, legendX + 14, y);
+			y += lineHeight;
+		}
+	}
+}
+
+void ProfilerOverlay::DrawGraph(RenderLayers& layers, int thread, int top, int height)
+{
+	const Profiler& profiler = Profiler::Get();
+	const int zoneCount = profiler.GetZoneCount();
+	const int frames = profiler.GetFrameCount();
+
+	// Background and 60 / 30 fps lines
+	layers.SetDrawColor(20, 20, 20, 255);
+	SDL_Rect background = { overlayX, top, profileHistorySize * barWidth, height };
+	layers.FillRect(background);
+
+	layers.SetDrawColor(90, 90, 90, 255);
+	const float targets[] = { 1000.0f / 60.0f, 1000.0f / 30.0f };
+	for (float target : targets) {
+		const int y = top + height - static_cast<int>(target * pixelsPerMs);
+		if (y > top) {
+			layers.DrawLine(overlayX, y, overlayX + profileHistorySize * barWidth, y);
+		}
+	}
+
+	// Stacked bars, oldest frame on the left, batched into one fill per zone
+	for (int column = 0; column < frames; ++column) {
+		const int framesAgo = frames - 1 - column;
+		int bottom = top + height;
+		for (int zone = 0; zone < zoneCount && bottom > top; ++zone) {
+			const int barHeight = static_cast<int>(profiler.GetZoneTime(framesAgo, thread, zone) * pixelsPerMs + 0.5f);
+			if (barHeight <= 0) {
+				continue;
+			}
+			const int barTop = std::max(bottom - barHeight, top);
+			SDL_Rect bar = { overlayX + column * barWidth, barTop, barWidth, bottom - barTop };
+			mBars[zone].push_back(bar);
+			bottom = barTop;
+		}
+	}
+	for (int zone = 0; zone < zoneCount; ++zone) {
+		if (!mBars[zone].empty()) {
+			layers.SetDrawColor(zoneColors[zone % zoneColorCount]);
+			layers.FillRects(mBars[zone].data(), static_cast<int>(mBars[zone].size()));
+			mBars[zone].clear();
+		}
+	}
+
+	if (mFont) {
+		DrawText(layers, profiler.GetThreadName(thread), overlayX + 4, top + 2);
+	}
+}
+
+bool ProfilerOverlay::HasZoneTime(int thread) const
+{
+	const Profiler& profiler = Profiler::Get();
+	for (int framesAgo = 0; framesAgo < profiler.GetFrameCount(); ++framesAgo) {
+		for (int zone = 0; zone < profiler.GetZoneCount(); ++zone) {
+			if (profiler.GetZoneTime(framesAgo, thread, zone) > 0.0f) {
+				return true;
+			}
+		}
+	}
+	return false;
+}
+
+void ProfilerOverlay::DrawText(RenderLayers& layers, const std::string& text, int x, int y)
+{
+	if (text.empty()) {
+		return;
+	}
+
+	SDL_Color white = { 255, 255, 255, 255 };
+	SDL_Surface* surface = TTF_RenderText_Blended(mFont, text.c_str(), white);
+	if (!surface) {
+		return;
+	}
+	SDL_Texture* texture = SDL_CreateTextureFromSurface(layers.GetRenderer(), surface);
+	SDL_Rect dest = { x, y, surface->w, surface->h };
+	SDL_FreeSurface(surface);
+
+	if (texture) {
+		layers.Copy(texture, NULL, &dest);
+		SDL_DestroyTexture(texture);
+	}
+}
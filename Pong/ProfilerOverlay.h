@@ -0,0 +1,44 @@
+#pragma once
+#include "Profiler.h"
+#include "RenderLayers.h"
+
+#include <SDL/SDL_ttf.h>
+
+#include <string>
+#include <vector>
+
+// Toggleable on-screen view of the profiler: a stacked graph of the last
+// profileHistorySize frames (one color per zone) for the thread that ends
+// frames, a smaller one for each other thread that recorded zones, plus a
+// legend with each zone's average time. Text needs a TrueType font; without
+// one the graphs are drawn on their own.
+class ProfilerOverlay
+{
+public:
+	ProfilerOverlay();
+
+	// Open the font (optional), call after the renderer exists
+	void Initialize();
+	void Shutdown();
+
+	void Toggle() { mVisible = !mVisible; }
+	bool IsVisible() const { return mVisible; }
+
+	// Extra lines shown under the legend (draw calls etc.), set every frame
+	void SetStatusLine(int line, const std::string& text);
+
+	// Draw into the current layer (the HUD)
+	void Draw(RenderLayers& layers);
+
+private:
+	// Stacked graph of one thread's zones, top and height in screen pixels
+	void DrawGraph(RenderLayers& layers, int thread, int top, int height);
+	bool HasZoneTime(int thread) const; // Any zone time in the history
+
+	void DrawText(RenderLayers& layers, const std::string& text, int x, int y);
+
+	bool mVisible;
+	TTF_Font* mFont;
+	std::vector<SDL_Rect> mBars[maxProfileZones]; // Reused every frame
+	std::vector<std::string> mStatusLines;
+};
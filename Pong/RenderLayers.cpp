@@ -0,0 +1,156 @@
+#include "RenderLayers.h"
+
+#if PROFILER_ENABLED
+// Profiler zone per layer (kept apart from the simulation's zones of the same name)
+static const char* const layerZoneNames[RenderLayerCount] = {
+	"Draw Sky",
+	"Draw Clouds",
+	"Draw World",
+	"Draw Entities",
+	"Draw Player",
+	"Draw HUD"
+};
+#endif
+
+RenderLayers::RenderLayers()
+{
+	mRenderer = nullptr;
+	mCurrentLayer = -1;
+	for (int i = 0; i < RenderLayerCount; ++i) {
+		mDrawCalls[i] = 0;
+		mLastDrawCalls[i] = 0;
+		mSubmits[i] = 0;
+#if PROFILER_ENABLED
+		mProfileZones[i] = Profiler::Get().RegisterZone(layerZoneNames[i]);
+#endif
+	}
+}
+
+void RenderLayers::BeginFrame()
+{
+	SDL_assert(mCurrentLayer == -1); // Previous frame never ended
+	for (int i = 0; i < RenderLayerCount; ++i) {
+		mDrawCalls[i] = 0;
+		mSubmits[i] = 0;
+	}
+}
+
+void RenderLayers::BeginLayer(RenderLayer layer)
+{
+	// Layers go back to front, each one exactly once
+	SDL_assert(layer > mCurrentLayer);
+	SDL_assert(mSubmits[layer] == 0);
+
+	++mSubmits[layer];
+#if PROFILER_ENABLED
+	if (mCurrentLayer >= 0) {
+		Profiler::Get().EndZone(mProfileZones[mCurrentLayer]);
+	}
+	Profiler::Get().BeginZone(mProfileZones[layer]);
+#endif
+	mCurrentLayer = layer;
+}
+
+void RenderLayers::EndFrame()
+{
+#if PROFILER_ENABLED
+	if (mCurrentLayer >= 0) {
+		Profiler::Get().EndZone(mProfileZones[mCurrentLayer]);
+	}
+#endif
+	for (int i = 0; i < RenderLayerCount; ++i) {
+		SDL_assert(mSubmits[i] == 1); // A layer was skipped
+		mLastDrawCalls[i] = mDrawCalls[i];
+	}
+	mCurrentLayer = -1;
+}
+
+void RenderLayers::CountDrawCall()
+{
+	SDL_assert(mCurrentLayer >= 0); // Drawing outside of a layer
+	if (mCurrentLayer >= 0) {
+		++mDrawCalls[mCurrentLayer];
+	}
+}
+
+void RenderLayers::SetDrawColor(const SDL_Color& color)
+{
+	SDL_SetRenderDrawColor(mRenderer, color.r, color.g, color.b, color.a);
+}
+
+void RenderLayers::SetDrawColor(Uint8 r, Uint8 g, Uint8 b, Uint8 a)
+{
+	SDL_SetRenderDrawColor(mRenderer, r, g, b, a);
+}
+
+void RenderLayers::Clear()
+{
+	CountDrawCall();
+	SDL_RenderClear(mRenderer);
+}
+
+void RenderLayers::FillRect(const SDL_Rect& rect)
+{
+	CountDrawCall();
+	SDL_RenderFillRect(mRenderer, &rect);
+}
+
+void RenderLayers::FillRects(const SDL_Rect* rects, int count)
+{
+	CountDrawCall();
+	SDL_RenderFillRects(mRenderer, rects, count);
+}
+
+void RenderLayers::DrawRect(const SDL_Rect& rect)
+{
+	CountDrawCall();
+	SDL_RenderDrawRect(mRenderer, &rect);
+}
+
+void RenderLayers::DrawLine(int x1, int y1, int x2, int y2)
+{
+	CountDrawCall();
+	SDL_RenderDrawLine(mRenderer, x1, y1, x2, y2);
+}
+
+void RenderLayers::Copy(SDL_Texture* texture, const SDL_Rect* srcRect, const SDL_Rect* dstRect)
+{
+	CountDrawCall();
+	SDL_RenderCopy(mRenderer, texture, srcRect, dstRect);
+}
+
+void RenderLayers::CopyEx(SDL_Texture* texture, const SDL_Rect* srcRect, const SDL_Rect* dstRect, SDL_RendererFlip flip)
+{
+	CountDrawCall();
+	SDL_RenderCopyEx(mRenderer, texture, srcRect, dstRect, 0.0, NULL, flip);
+}
+
+int RenderLayers::GetTotalDrawCalls() const
+{
+	int total = 0;
+	for (int i = 0; i < RenderLayerCount; ++i) {
+		total += mLastDrawCalls[i];
+	}
+	return total;
+}
+
+void RenderLayers::LogStats() const
+{
+	SDL_Log("Draw calls last frame: %d", GetTotalDrawCalls());
+	for (int i = 0; i < RenderLayerCount; ++i) {
+		SDL_Log("  %-10s %d", GetLayerName(static_cast<RenderLayer>(i)), mLastDrawCalls[i]);
+	}
+}
+
+const char* RenderLayers::GetLayerName(RenderLayer layer)
+{
+	switch (layer) {
+	case LayerSky:      return "Sky";
+	case LayerClouds:   return "Clouds";
+	case LayerWorld:    return "World";
+	case LayerEntities: return "Entities";
+	case LayerPlayer:   return "Player";
+	case LayerHUD:      return "HUD";
+	default:            return "?";
+	}
+}
@@ -0,0 +1,69 @@
+#pragma once
+#include "SDL/SDL.h"
+#include "Profiler.h"
+
+// Render layers, back to front. Every frame submits each layer exactly once, in this order.
+enum RenderLayer
+{
+	LayerSky,
+	LayerClouds,
+	LayerWorld,
+	LayerEntities,
+	LayerPlayer,
+	LayerHUD,
+	RenderLayerCount
+};
+
+// Thin wrapper around SDL_Renderer that draws into ordered layers and counts
+// draw calls per layer per frame. In debug builds it asserts that each layer
+// is submitted once per frame and in order, so an accidental second pass over
+// the world (or the HUD) gets caught right away. Each layer is also timed
+// as its own profiler zone.
+class RenderLayers
+{
+public:
+	RenderLayers();
+
+	void SetRenderer(SDL_Renderer* renderer) { mRenderer = renderer; }
+	SDL_Renderer* GetRenderer() const { return mRenderer; }
+
+	// Redirect drawing into a texture (nullptr for the window)
+	void SetTarget(SDL_Texture* texture) { SDL_SetRenderTarget(mRenderer, texture); }
+	SDL_Texture* GetTarget() const { return SDL_GetRenderTarget(mRenderer); }
+
+	void BeginFrame();
+	void BeginLayer(RenderLayer layer);
+	void EndFrame();
+
+	// Draw calls, counted against the current layer
+	void SetDrawColor(const SDL_Color& color);
+	void SetDrawColor(Uint8 r, Uint8 g, Uint8 b, Uint8 a);
+	void Clear();
+	void FillRect(const SDL_Rect& rect);
+	void FillRects(const SDL_Rect* rects, int count);
+	void DrawRect(const SDL_Rect& rect);
+	void DrawLine(int x1, int y1, int x2, int y2);
+	void Copy(SDL_Texture* texture, const SDL_Rect* srcRect, const SDL_Rect* dstRect);
+	void CopyEx(SDL_Texture* texture, const SDL_Rect* srcRect, const SDL_Rect* dstRect, SDL_RendererFlip flip);
+
+	// Counters from the last completed frame
+	int GetDrawCalls(RenderLayer layer) const { return mLastDrawCalls[layer]; }
+	int GetTotalDrawCalls() const;
+
+	// Write the last frame's counters to the log
+	void LogStats() const;
+
+	static const char* GetLayerName(RenderLayer layer);
+
+private:
+	void CountDrawCall();
+
+	SDL_Renderer* mRenderer;
+	int mCurrentLayer; // -1 outside of a frame
+	int mDrawCalls[RenderLayerCount];
+	int mLastDrawCalls[RenderLayerCount];
+	int mSubmits[RenderLayerCount];
+#if PROFILER_ENABLED
+	int mProfileZones[RenderLayerCount];
+#endif
+};
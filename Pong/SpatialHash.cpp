@@ -0,0 +1,73 @@
+#include "SpatialHash.h"
+
+#include <cmath>
+
+SpatialHash::SpatialHash(int cellSize)
+{
+	mCellSize = cellSize;
+	mCount = 0;
+}
+
+void SpatialHash::Insert(PoolHandle handle, const Vector2& position)
+{
+	RemoveSlot(handle.index); // Moved, or a stale handle from an earlier generation
+
+	const int cellX = FloorDiv(static_cast<int>(std::floor(position.x)), mCellSize);
+	const int cellY = FloorDiv(static_cast<int>(std::floor(position.y)), mCellSize);
+	const Uint64 key = CellKey(cellX, cellY);
+	std::vector<PoolHandle>& bucket = mCells[key];
+
+	if (handle.index >= mLocations.size()) {
+		mLocations.resize(handle.index + 1, Location{ 0, -1 });
+	}
+	mLocations[handle.index].cell = key;
+	mLocations[handle.index].slot = static_cast<int>(bucket.size());
+	bucket.push_back(handle);
+	++mCount;
+}
+
+void SpatialHash::Remove(PoolHandle handle)
+{
+	if (handle.index >= mLocations.size() || mLocations[handle.index].slot < 0) {
+		return;
+	}
+
+	// The pool slot may hold a newer object than handle, leave that one alone
+	const Location& location = mLocations[handle.index];
+	if (mCells.find(location.cell)->second[location.slot].generation != handle.generation) {
+		return;
+	}
+	RemoveSlot(handle.index);
+}
+
+void SpatialHash::RemoveSlot(Uint32 index)
+{
+	if (index >= mLocations.size() || mLocations[index].slot < 0) {
+		return;
+	}
+
+	Location& location = mLocations[index];
+	auto cell = mCells.find(location.cell);
+	SDL_assert(cell != mCells.end());
+	std::vector<PoolHandle>& bucket = cell->second;
+	SDL_assert(bucket[location.slot].index == index);
+
+	// Swap and pop, the moved handle takes over the slot
+	const PoolHandle moved = bucket.back();
+	bucket[location.slot] = moved;
+	mLocations[moved.index].slot = location.slot;
+	bucket.pop_back();
+	if (bucket.empty()) {
+		mCells.erase(cell); // Keep the map to the cells in use, queries and memory stay bounded
+	}
+
+	location.slot = -1;
+	--mCount;
+}
+
+void SpatialHash::Clear()
+{
+	mCells.clear();
+	mLocations.clear();
+	mCount = 0;
+}
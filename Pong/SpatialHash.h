@@ -0,0 +1,65 @@
+#pragma once
+#include "SDL/SDL.h"
+#include "Collision.h"
+#include "Pool.h"
+#include "Vector2.h"
+
+#include <unordered_map>
+#include <vector>
+
+// Uniform grid of buckets over an unbounded world, for pooled objects that
+// don't move (pickups). Each object sits in the bucket of the cell holding
+// its position; insert and remove are O(1) (remove swaps the bucket's last
+// entry into the hole), and a query only visits the cells a rect covers.
+class SpatialHash
+{
+public:
+	explicit SpatialHash(int cellSize);
+
+	// Inserting a handle again moves it. Removing a handle that isn't in the
+	// hash, or is from an older generation than the one stored, does nothing.
+	void Insert(PoolHandle handle, const Vector2& position);
+	void Remove(PoolHandle handle);
+	void Clear();
+
+	// Append every handle whose position lies in a cell that rect touches.
+	// Callers grow rect by the objects' size up and left, since objects
+	// are bucketed by their top left corner. Results is any vector of
+	// PoolHandle (usually a FrameVector).
+	template <typename Results>
+	void Query(const SDL_Rect& rect, Results& results) const
+	{
+		CellRange cells = GetOverlappingCells(rect, mCellSize);
+		for (int cellY = cells.minY; cellY <= cells.maxY; ++cellY) {
+			for (int cellX = cells.minX; cellX <= cells.maxX; ++cellX) {
+				auto iter = mCells.find(CellKey(cellX, cellY));
+				if (iter != mCells.end()) {
+					results.insert(results.end(), iter->second.begin(), iter->second.end());
+				}
+			}
+		}
+	}
+
+	int GetCellSize() const { return mCellSize; }
+	int GetCount() const { return mCount; }
+
+private:
+	// Where an object is stored, indexed by pool slot
+	struct Location
+	{
+		Uint64 cell;
+		int slot; // -1 when the object isn't in the hash
+	};
+
+	void RemoveSlot(Uint32 index); // Whatever handle has that pool slot
+
+	static Uint64 CellKey(int cellX, int cellY)
+	{
+		return (static_cast<Uint64>(static_cast<Uint32>(cellX)) << 32) | static_cast<Uint32>(cellY);
+	}
+
+	int mCellSize;
+	int mCount;
+	std::unordered_map<Uint64, std::vector<PoolHandle>> mCells;
+	std::vector<Location> mLocations;
+};
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <atomic>
+
+// Fixed size queue between exactly one producer thread and one consumer
+// thread, without locks. Push fails when full and Pop when empty; holds
+// up to Capacity - 1 items. Items are copied in and out, so slots keep
+// whatever memory their members allocated (vectors are reused).
+template <typename T, int Capacity>
+class SpscQueue
+{
+public:
+	SpscQueue()
+		: mHead(0)
+		, mTail(0)
+	{
+	}
+
+	// Producer thread only
+	bool Push(const T& item)
+	{
+		const int tail = mTail.load(std::memory_order_relaxed);
+		const int next = (tail + 1) % Capacity;
+		if (next == mHead.load(std::memory_order_acquire)) {
+			return false; // Full
+		}
+		mItems[tail] = item;
+		mTail.store(next, std::memory_order_release);
+		return true;
+	}
+
+	// Consumer thread only
+	bool Pop(T& item)
+	{
+		const int head = mHead.load(std::memory_order_relaxed);
+		if (head == mTail.load(std::memory_order_acquire)) {
+			return false; // Empty
+		}
+		item = mItems[head];
+		mHead.store((head + 1) % Capacity, std::memory_order_release);
+		return true;
+	}
+
+	bool IsEmpty() const
+	{
+		return mHead.load(std::memory_order_acquire) == mTail.load(std::memory_order_acquire);
+	}
+
+private:
+	T mItems[Capacity];
+	std::atomic<int> mHead; // Next item to pop
+	std::atomic<int> mTail; // Next free slot
+};
@@ -0,0 +1,48 @@
+#pragma once
+
+#include <atomic>
+
+// Lock-free handoff of the latest state from one writer thread to one
+// reader thread. The writer fills the back buffer and publishes it, the
+// reader picks up the most recently published one. A third buffer sits
+// between the two, so neither side ever waits for the other; snapshots the
+// reader was too slow to pick up are skipped.
+template <typename T>
+class TripleBuffer
+{
+public:
+	TripleBuffer()
+		: mBack(0)
+		, mMiddle(1)
+		, mFront(2)
+	{
+	}
+
+	// Writer: the buffer to fill in, then Publish it
+	T& GetBack() { return mBuffers[mBack]; }
+	void Publish()
+	{
+		mBack = mMiddle.exchange(mBack | newFlag, std::memory_order_acq_rel) & indexMask;
+	}
+
+	// Reader: switch to the latest published buffer, false if nothing new
+	// was published since the last call
+	bool Acquire()
+	{
+		if (!(mMiddle.load(std::memory_order_acquire) & newFlag)) {
+			return false;
+		}
+		mFront = mMiddle.exchange(mFront, std::memory_order_acq_rel) & indexMask;
+		return true;
+	}
+	const T& GetFront() const { return mBuffers[mFront]; }
+
+private:
+	static const int indexMask = 3;
+	static const int newFlag = 4; // Middle holds a buffer the reader hasn't seen
+
+	T mBuffers[3];
+	int mBack;               // Writer thread only
+	std::atomic<int> mMiddle;
+	int mFront;              // Reader thread only
+};
@@ -0,0 +1,7 @@
+#pragma once
+
+struct Vector2
+{
+	float x;
+	float y;
+};
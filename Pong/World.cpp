@@ -0,0 +1,103 @@
+#include "World.h"
+#include "Collision.h"
+
+#include <algorithm>
+#include <iterator>
+
+const SDL_Color blockPalette[blockPaletteSize] = {
+	{128, 0, 128, 255},   // Empty (never drawn)
+	{255, 255, 255, 255}, // White
+	{192, 192, 192, 255}, // Light Gray
+	{128, 128, 128, 255}, // Gray
+	{64, 64, 64, 255},    // Dark Gray
+	{255, 0, 0, 255},     // Red
+	{0, 255, 0, 255},     // Green
+	{0, 0, 255, 255},     // Blue
+	{255, 255, 0, 255},   // Yellow
+	{0, 0, 0, 255}        // Black
+};
+
+BlockId World::Get(int x, int y) const
+{
+	const int chunkX = FloorDiv(x, chunkSize);
+	const int chunkY = FloorDiv(y, chunkSize);
+	const Chunk* chunk = FindChunk(chunkX, chunkY);
+	if (!chunk) {
+		return emptyBlock;
+	}
+
+	const int localX = x - chunkX * chunkSize;
+	const int localY = y - chunkY * chunkSize;
+	return chunk->blocks[localY * chunkSize + localX];
+}
+
+void World::Set(int x, int y, BlockId id)
+{
+	const int chunkX = FloorDiv(x, chunkSize);
+	const int chunkY = FloorDiv(y, chunkSize);
+	const Uint64 key = ChunkKey(chunkX, chunkY);
+
+	auto iter = mChunks.find(key);
+	if (iter == mChunks.end()) {
+		// Clearing a cell in a chunk that doesn't exist is a no-op
+		if (id == emptyBlock) {
+			return;
+		}
+
+		std::unique_ptr<Chunk> chunk(new Chunk);
+		chunk->chunkX = chunkX;
+		chunk->chunkY = chunkY;
+		chunk->blockCount = 0;
+		chunk->revision = 0;
+		std::fill(std::begin(chunk->blocks), std::end(chunk->blocks), emptyBlock);
+		iter = mChunks.emplace(key, std::move(chunk)).first;
+	}
+
+	Chunk& chunk = *iter->second;
+	const int localX = x - chunkX * chunkSize;
+	const int localY = y - chunkY * chunkSize;
+	BlockId& cell = chunk.blocks[localY * chunkSize + localX];
+	if (cell == id) {
+		return;
+	}
+
+	if (cell == emptyBlock && id != emptyBlock) {
+		++chunk.blockCount;
+	}
+	else if (cell != emptyBlock && id == emptyBlock) {
+		--chunk.blockCount;
+	}
+	cell = id;
+	chunk.revision = ++mRevision;
+
+	// Free chunks as soon as they're empty
+	if (chunk.blockCount == 0) {
+		mChunks.erase(iter);
+	}
+}
+
+const Chunk* World::FindChunk(int chunkX, int chunkY) const
+{
+	auto iter = mChunks.find(ChunkKey(chunkX, chunkY));
+	return iter != mChunks.end() ? iter->second.get() : nullptr;
+}
+
+Uint32 World::GetChecksum() const
+{
+	// FNV-1a per chunk, summed so the hash map's iteration order doesn't matter
+	Uint32 checksum = 0;
+	for (const auto& entry : mChunks) {
+		const Chunk& chunk = *entry.second;
+		Uint32 hash = 2166136261u;
+		const int coords[2] = { chunk.chunkX, chunk.chunkY };
+		const Uint8* bytes = reinterpret_cast<const Uint8*>(coords);
+		for (size_t i = 0; i < sizeof(coords); ++i) {
+			hash = (hash ^ bytes[i]) * 16777619u;
+		}
+		for (BlockId id : chunk.blocks) {
+			hash = (hash ^ id) * 16777619u;
+		}
+		checksum += hash;
+	}
+	return checksum;
+}
@@ -0,0 +1,118 @@
+#pragma once
+#include "SDL/SDL.h"
+
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+// Block type ID, an index into blockPalette. Stored one byte per cell,
+// shared by the world, the inventory and pickups.
+typedef Uint8 BlockId;
+
+// ID 0 is empty space, everything else is a placeable block
+const BlockId emptyBlock = 0;
+const int blockPaletteSize = 10;
+
+// Draw color for each block ID
+extern const SDL_Color blockPalette[blockPaletteSize];
+
+// Width and height of a world chunk in cells
+const int chunkSize = 32;
+
+// A chunkSize x chunkSize block of cells, stored row-major
+struct Chunk {
+	int chunkX; // Chunk coordinates (cell coordinates / chunkSize)
+	int chunkY;
+	int blockCount; // Non-empty cells, the chunk is freed when this reaches 0
+	Uint32 revision; // Changes whenever a cell in the chunk does (unique across the world)
+	BlockId blocks[chunkSize * chunkSize];
+};
+
+// Unbounded world made of chunks, kept in a hash map by chunk coordinate.
+// Chunks are allocated when a block is first written into them and freed
+// once they're empty again, so memory grows with the number of placed
+// blocks rather than with the size of the world.
+class World
+{
+public:
+	typedef std::unordered_map<Uint64, std::unique_ptr<Chunk>> ChunkMap;
+
+	// Block at cell x, y (emptyBlock if its chunk doesn't exist)
+	BlockId Get(int x, int y) const;
+
+	// Write a block, allocating or freeing its chunk as needed
+	void Set(int x, int y, BlockId id);
+
+	World() : mRevision(0) {}
+
+	// Chunk at chunk coordinates cx, cy (nullptr if nothing is there)
+	const Chunk* FindChunk(int chunkX, int chunkY) const;
+
+	const ChunkMap& GetChunks() const { return mChunks; }
+
+	// Hash of every block in the world, independent of chunk storage order
+	Uint32 GetChecksum() const;
+	size_t GetChunkCount() const { return mChunks.size(); }
+
+private:
+	static Uint64 ChunkKey(int chunkX, int chunkY)
+	{
+		return (static_cast<Uint64>(static_cast<Uint32>(chunkX)) << 32) | static_cast<Uint32>(chunkY);
+	}
+
+	ChunkMap mChunks;
+	Uint32 mRevision; // Last revision handed out to a chunk
+};
+
+// Fixed size block storage in one contiguous allocation.
+// Cells are stored row-major (y * width + x), which matches the order
+// blocks are drawn in, so loops should go y outer, x inner.
+class BlockGrid
+{
+public:
+	BlockGrid(int width, int height)
+		: mWidth(width)
+		, mHeight(height)
+		, mBlocks(static_cast<size_t>(width) * height, emptyBlock)
+	{
+	}
+
+	int GetWidth() const { return mWidth; }
+	int GetHeight() const { return mHeight; }
+
+	bool InBounds(int x, int y) const
+	{
+		return x >= 0 && x < mWidth && y >= 0 && y < mHeight;
+	}
+
+	// Bounds are only checked in debug builds (SDL_assert compiles out in release)
+	BlockId& At(int x, int y)
+	{
+		SDL_assert(InBounds(x, y));
+		return mBlocks[static_cast<size_t>(y) * mWidth + x];
+	}
+
+	BlockId At(int x, int y) const
+	{
+		SDL_assert(InBounds(x, y));
+		return mBlocks[static_cast<size_t>(y) * mWidth + x];
+	}
+
+	// Pointer to the first block of a row, for scanline loops
+	BlockId* Row(int y)
+	{
+		SDL_assert(y >= 0 && y < mHeight);
+		return &mBlocks[static_cast<size_t>(y) * mWidth];
+	}
+
+	const BlockId* Row(int y) const
+	{
+		SDL_assert(y >= 0 && y < mHeight);
+		return &mBlocks[static_cast<size_t>(y) * mWidth];
+	}
+
+private:
+	int mWidth;
+	int mHeight;
+	std::vector<BlockId> mBlocks;
+};